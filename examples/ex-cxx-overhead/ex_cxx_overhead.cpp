@@ -52,6 +52,8 @@ struct basic
 {};
 struct blank
 {};
+struct literal
+{};
 struct none
 {};
 struct basic_pointer
@@ -142,6 +144,22 @@ fibonacci(int64_t n, int64_t cutoff,
 
 //======================================================================================//
 
+template <typename Tp>
+int64_t
+fibonacci(int64_t n, int64_t cutoff,
+          tim::enable_if_t<std::is_same<Tp, mode::literal>::value, int> = 0)
+{
+    if(n > cutoff)
+    {
+        TIMEMORY_LITERAL_MARKER(auto_tuple_t, "fibonacci");
+        return (n < 2) ? n
+                       : (fibonacci<Tp>(n - 1, cutoff) + fibonacci<Tp>(n - 2, cutoff));
+    }
+    return fibonacci(n);
+}
+
+//======================================================================================//
+
 template <typename Tp>
 int64_t
 fibonacci(int64_t n, int64_t cutoff,
@@ -287,6 +305,7 @@ run(int64_t n, int64_t cutoff, bool store = true)
 {
     // bool is_none  = std::is_same<Tp, mode::none>::value;
     bool is_blank = std::is_same<Tp, mode::blank>::value ||
+                    std::is_same<Tp, mode::literal>::value ||
                     std::is_same<Tp, mode::blank_pointer>::value ||
                     std::is_same<Tp, mode::chained>::value;
     bool is_basic = std::is_same<Tp, mode::basic>::value ||
@@ -451,6 +470,7 @@ main(int argc, char** argv)
     launch<mode::manual>(nitr, nfib, cutoff, ex_measure, ex_unique, timer_list);
     launch<mode::single>(nitr, nfib, cutoff, ex_measure, ex_unique, timer_list);
     launch<mode::blank>(nitr, nfib, cutoff, ex_measure, ex_unique, timer_list);
+    launch<mode::literal>(nitr, nfib, cutoff, ex_measure, ex_unique, timer_list);
     launch<mode::blank_pointer>(nitr, nfib, cutoff, ex_measure, ex_unique, timer_list);
     launch<mode::chained>(nitr, nfib, cutoff, ex_measure, ex_unique, timer_list);
     launch<mode::basic>(nitr, nfib, cutoff, ex_measure, ex_unique, timer_list);
@@ -26,15 +26,18 @@
 #include "timemory/config.hpp"
 #include "timemory/library.h"
 #include "timemory/runtime/configure.hpp"
+#include "timemory/storage/node_id_map.hpp"
 #include "timemory/timemory.hpp"
 #include "timemory/trace.hpp"
+#include "timemory/utility/slot_pool.hpp"
 
+#include <atomic>
 #include <cstdarg>
 #include <deque>
 #include <iostream>
-#include <stack>
+#include <limits>
+#include <mutex>
 #include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 using namespace tim::component;
@@ -52,34 +55,99 @@ extern "C"
 using string_t           = std::string;
 using library_toolset_t  = TIMEMORY_LIBRARY_TYPE;
 using toolset_t          = typename library_toolset_t::component_type;
-using region_map_t       = std::unordered_map<std::string, std::stack<uint64_t>>;
-using record_map_t       = std::unordered_map<uint64_t, toolset_t>;
+using record_pool_t      = tim::slot_pool<toolset_t>;
 using component_enum_t   = std::vector<TIMEMORY_COMPONENT>;
 using components_stack_t = std::deque<component_enum_t>;
 
+//--------------------------------------------------------------------------------------//
+//
+/// the region names are interned once and referred to by a dense handle which is
+/// shared by all threads
+struct region_registry
+{
+    std::mutex                                mutex = {};
+    std::unordered_map<std::string, uint64_t> ids   = {};
+    std::deque<std::string>                   names = {};
+};
+
+/// the per-thread state of a region: the interned name and the record ids of the
+/// pushed instances of the region
+struct region_entry
+{
+    const char*           name  = nullptr;
+    std::vector<uint64_t> stack = {};
+};
+
+// indexed by the region handle
+using region_table_t = std::vector<region_entry>;
+// maps the hash of the region name to the region handle
+using region_cache_t = tim::node_id_map<uint64_t>;
+
+
 static std::string spacer =
     "#-------------------------------------------------------------------------#";
 
 //--------------------------------------------------------------------------------------//
 
-static record_map_t&
-get_record_map()
+// the records are shared by all threads so a record may be ended on any thread
+static record_pool_t&
+get_record_pool()
 {
-    static thread_local record_map_t _instance;
+    static record_pool_t _instance{};
     return _instance;
 }
 
 //--------------------------------------------------------------------------------------//
 
-static region_map_t&
-get_region_map()
+static region_registry&
+get_region_registry()
 {
-    static thread_local region_map_t _instance;
+    static region_registry _instance{};
     return _instance;
 }
 
 //--------------------------------------------------------------------------------------//
 
+static region_table_t&
+get_region_table()
+{
+    static thread_local region_table_t _instance{};
+    return _instance;
+}
+
+//--------------------------------------------------------------------------------------//
+
+static region_cache_t&
+get_region_cache()
+{
+    static thread_local region_cache_t _instance{};
+    return _instance;
+}
+
+//--------------------------------------------------------------------------------------//
+//
+//  returns nullptr if the handle was not returned by timemory_register_region. Only the
+//  first use of a handle on each thread acquires the lock on the registry
+//
+static region_entry*
+get_region_entry(uint64_t _handle)
+{
+    auto& _table = get_region_table();
+    if(_handle < _table.size() && _table[_handle].name)
+        return &_table[_handle];
+
+    auto&                       _registry = get_region_registry();
+    std::lock_guard<std::mutex> _lk{ _registry.mutex };
+    if(_handle >= _registry.names.size())
+        return nullptr;
+    if(_handle >= _table.size())
+        _table.resize(_handle + 1);
+    _table[_handle].name = _registry.names[_handle].c_str();
+    return &_table[_handle];
+}
+
+//--------------------------------------------------------------------------------------//
+
 static components_stack_t&
 get_components_stack()
 {
@@ -125,6 +193,22 @@ get_library_state()
     return _instance;
 }
 
+//--------------------------------------------------------------------------------------//
+//
+//  creates a record with the current components. The caller holds the trace lock
+//
+static uint64_t
+begin_region_record(const char* name)
+{
+    if(tim::settings::enabled() == false)
+        return std::numeric_limits<uint64_t>::max();
+
+    uint64_t id   = 0;
+    auto&    comp = get_current_components();
+    timemory_create_record(name, &id, comp.size(), (int*) (comp.data()));
+    return id;
+}
+
 //--------------------------------------------------------------------------------------//
 //
 //      timemory symbols
@@ -138,10 +222,7 @@ extern "C"
     //
     uint64_t timemory_get_unique_id(void)
     {
-        // the maps are thread-local so no concerns for data-race here since
-        // two threads updating at once and subsequently losing once of the updates
-        // still results in a unique id for that thread
-        static uint64_t uniqID = 0;
+        static std::atomic<uint64_t> uniqID{ 0 };
         return uniqID++;
     }
 
@@ -157,13 +238,14 @@ extern "C"
         }
         // else: provide default behavior
 
-        static thread_local auto& _record_map = get_record_map();
-        *id                                   = timemory_get_unique_id();
-        _record_map.insert({ *id, toolset_t(name, true) });
-        tim::initialize(_record_map[*id], n, ctypes);
-        _record_map[*id].start();
-        if(_record_map.bucket_count() > _record_map.size())
-            _record_map.rehash(_record_map.size() + 10);
+        // the id encodes the slot index and generation of the record
+        auto& _record_pool = get_record_pool();
+        *id                = _record_pool.acquire(name, true);
+        auto* _record      = _record_pool.get(*id);
+        if(!_record)
+            return;
+        tim::initialize(*_record, n, ctypes);
+        _record->start();
     }
 
     //----------------------------------------------------------------------------------//
@@ -175,12 +257,11 @@ extern "C"
         {
             (*timemory_delete_function)(id);
         }
-        else if(get_record_map().find(id) != get_record_map().end())
+        else
         {
-            static thread_local auto& _record_map = get_record_map();
-            // stop recording, destroy objects, and erase key from map
-            _record_map[id].stop();
-            _record_map.erase(id);
+            // stop recording and recycle the slot. Unknown, stale, or already deleted
+            // ids are ignored
+            get_record_pool().release(id, [](toolset_t& _record) { _record.stop(); });
         }
     }
 
@@ -218,11 +299,9 @@ extern "C"
         tim::trace::lock<tim::trace::library> lk{};
         get_library_state()[1] = true;
 
-        if(tim::settings::enabled() == false && get_record_map().empty())
+        if(tim::settings::enabled() == false && get_record_pool().empty())
             return;
 
-        auto& _record_map = get_record_map();
-
         if(tim::settings::verbose() > 0)
         {
             printf("\n%s\n", spacer.c_str());
@@ -230,18 +309,16 @@ extern "C"
             printf("%s\n\n", spacer.c_str());
         }
 
-        // put keys into a set so that a potential LD_PRELOAD for timemory_delete_record
-        // is called and there is not a concern for the map iterator
-        std::unordered_set<uint64_t> keys;
-        for(auto& itr : _record_map)
-            keys.insert(itr.first);
+        // collect the ids so that a potential LD_PRELOAD for timemory_delete_record
+        // is called
+        auto keys = get_record_pool().get_ids();
 
         // delete all the records
         for(auto& itr : keys)
             timemory_delete_record(itr);
 
-        // clear the map
-        _record_map.clear();
+        // destroy any records not deleted by an LD_PRELOAD
+        get_record_pool().clear();
 
         // have the manager finalize
         tim::manager::instance()->finalize();
@@ -513,37 +590,82 @@ extern "C"
 
     //----------------------------------------------------------------------------------//
 
-    void timemory_push_region(const char* name)
+    uint64_t timemory_register_region(const char* name)
+    {
+        auto&                       _registry = get_region_registry();
+        std::lock_guard<std::mutex> _lk{ _registry.mutex };
+        auto                        itr = _registry.ids.find(name);
+        if(itr != _registry.ids.end())
+            return itr->second;
+        _registry.names.emplace_back(name);
+        return _registry.ids.emplace(name, _registry.names.size() - 1).first->second;
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    void timemory_push_region_handle(uint64_t handle)
     {
         tim::trace::lock<tim::trace::library> lk{};
         if(!lk)
             return;
-        auto& region_map = get_region_map();
-        lk.release();
-        auto idx = timemory_get_begin_record(name);
-        lk       = tim::trace::lock<tim::trace::library>{};
-        region_map[name].push(idx);
+        auto* _entry = get_region_entry(handle);
+        if(!_entry)
+        {
+            fprintf(stderr, "Warning! region handle %llu does not exist!\n",
+                    (unsigned long long) handle);
+            return;
+        }
+        _entry->stack.emplace_back(begin_region_record(_entry->name));
     }
 
     //----------------------------------------------------------------------------------//
 
-    void timemory_pop_region(const char* name)
+    void timemory_pop_region_handle(uint64_t handle)
     {
         tim::trace::lock<tim::trace::library> lk{};
         if(!lk)
             return;
-        auto& region_map = get_region_map();
-        auto  itr        = region_map.find(name);
-        if(itr == region_map.end() || (itr != region_map.end() && itr->second.empty()))
-            fprintf(stderr, "Warning! region '%s' does not exist!\n", name);
-        else
+        auto* _entry = get_region_entry(handle);
+        if(!_entry || _entry->stack.empty())
         {
-            uint64_t idx = itr->second.top();
-            lk.release();
-            timemory_end_record(idx);
-            lk = tim::trace::lock<tim::trace::library>{};
-            itr->second.pop();
+            if(_entry)
+                fprintf(stderr, "Warning! region '%s' does not exist!\n", _entry->name);
+            else
+                fprintf(stderr, "Warning! region handle %llu does not exist!\n",
+                        (unsigned long long) handle);
+            return;
         }
+        uint64_t idx = _entry->stack.back();
+        _entry->stack.pop_back();
+        if(idx != std::numeric_limits<uint64_t>::max())
+            timemory_delete_record(idx);
+    }
+
+    //----------------------------------------------------------------------------------//
+    //
+    //  the string variants only hash the name after the first call on each thread
+    //
+    void timemory_push_region(const char* name)
+    {
+        auto  _hash   = tim::get_hash_id(name);
+        auto* _handle = get_region_cache().find(0, _hash);
+        if(!_handle)
+            _handle = &get_region_cache().insert(0, _hash, timemory_register_region(name));
+        timemory_push_region_handle(*_handle);
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    void timemory_pop_region(const char* name)
+    {
+        auto  _hash   = tim::get_hash_id(name);
+        auto* _handle = get_region_cache().find(0, _hash);
+        if(!_handle)
+        {
+            fprintf(stderr, "Warning! region '%s' does not exist!\n", name);
+            return;
+        }
+        timemory_pop_region_handle(*_handle);
     }
 
     //==================================================================================//
@@ -604,6 +726,21 @@ extern "C"
 
     void timemory_pop_region_(const char* name) { return timemory_pop_region(name); }
 
+    uint64_t timemory_register_region_(const char* name)
+    {
+        return timemory_register_region(name);
+    }
+
+    void timemory_push_region_handle_(uint64_t handle)
+    {
+        timemory_push_region_handle(handle);
+    }
+
+    void timemory_pop_region_handle_(uint64_t handle)
+    {
+        timemory_pop_region_handle(handle);
+    }
+
     //======================================================================================//
 
 }  // extern "C"
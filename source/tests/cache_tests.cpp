@@ -533,6 +533,43 @@ TEST_F(cache_tests, lightweight_tuple)
 
 //--------------------------------------------------------------------------------------//
 
+TEST_F(cache_tests, shared_cache)
+{
+    using shared_type = tim::operation::construct_shared_cache_t<
+        std::tuple<peak_rss, num_minor_page_faults*, wall_clock, read_bytes>>;
+    using mixed_type =
+        tim::operation::construct_shared_cache_t<peak_rss, user_mode_time, read_bytes,
+                                                 written_bytes, wall_clock>;
+    using single_type = tim::operation::construct_shared_cache_t<peak_rss, read_bytes>;
+
+    std::cout << "shared type       : " << tim::demangle<shared_type>() << std::endl;
+    std::cout << "mixed type        : " << tim::demangle<mixed_type>() << std::endl;
+    std::cout << "single type       : " << tim::demangle<single_type>() << std::endl;
+
+    auto check1 = std::is_same<shared_type,
+                               tim::operation::shared_cache<tim::rusage_cache>>::value;
+    auto check2 =
+        std::is_same<mixed_type, tim::operation::shared_cache<tim::rusage_cache,
+                                                               tim::io_cache>>::value;
+    auto check3 = std::is_same<single_type, tim::operation::shared_cache<>>::value;
+    EXPECT_TRUE(check1);
+    EXPECT_TRUE(check2);
+    EXPECT_TRUE(check3);
+
+    // the bundle reads the shared cache on start/stop without arguments
+    bundle_t _bundle{ details::get_test_name(),
+                      tim::quirk::config<tim::quirk::no_store>{} };
+    _bundle.start();
+    details::allocate_basic();
+    _bundle.stop();
+
+    EXPECT_GE(_bundle.get<peak_rss>()->get(), 0.0);
+    EXPECT_GE(_bundle.get<num_minor_page_faults>()->get(), 0);
+    EXPECT_GE(_bundle.get<voluntary_context_switch>()->get(), 0);
+}
+
+//--------------------------------------------------------------------------------------//
+
 template <typename Tp, typename Arg,
           tim::enable_if_t<tim::trait::is_available<Tp>::value> = 0>
 double
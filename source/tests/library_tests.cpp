@@ -213,6 +213,37 @@ TEST_F(library_tests, get_record)
 
 //--------------------------------------------------------------------------------------//
 
+TEST_F(library_tests, record_handles)
+{
+    timemory_push_components("wall_clock");
+
+    // a record created on this thread can be ended on another thread
+    uint64_t idx = 0;
+    timemory_begin_record(TEST_NAME, &idx);
+    ret += details::fibonacci(35);
+    std::thread{ [idx]() { timemory_end_record(idx); } }.join();
+
+    // ending the same record again is ignored
+    timemory_end_record(idx);
+
+    // the slot is recycled but the handle of the new record is different
+    uint64_t nidx = 0;
+    timemory_begin_record(TEST_NAME, &nidx);
+    ret += details::fibonacci(35);
+    EXPECT_NE(idx, nidx);
+    EXPECT_EQ(idx & 0xffffffff, nidx & 0xffffffff);
+    timemory_end_record(idx);
+    timemory_end_record(nidx);
+
+    timemory_pop_components();
+
+    printf("fibonacci(35) = %li\n\n", ret);
+
+    ASSERT_EQ(get_wc_storage_size(), wc_size_orig + 1);
+}
+
+//--------------------------------------------------------------------------------------//
+
 TEST_F(library_tests, scoped_record)
 {
     printf("TEST_NAME: %s\n", details::get_test_name().c_str());
@@ -421,6 +452,44 @@ TEST_F(library_tests, region)
 
 //--------------------------------------------------------------------------------------//
 
+TEST_F(library_tests, region_handle)
+{
+    auto handle = timemory_register_region(TEST_NAME);
+    EXPECT_EQ(handle, timemory_register_region(TEST_NAME));
+    EXPECT_NE(handle, timemory_register_region(
+                          TIMEMORY_JOIN("/", TEST_NAME, "other").c_str()));
+
+    timemory_push_region_handle(handle);
+    ret += details::fibonacci(35);
+
+    // the string and handle variants refer to the same region
+    timemory_push_region(TEST_NAME);
+    ret += details::fibonacci(35);
+
+    timemory_pop_region_handle(handle);
+    timemory_pop_region(TEST_NAME);
+
+    // handles are valid on every thread
+    std::thread{ [handle]() {
+        timemory_push_region_handle(handle);
+        timemory_pop_region_handle(handle);
+    } }.join();
+
+    printf("fibonacci(35) = %li\n\n", ret);
+
+    auto wc_n = wc_size_orig + 2;
+    auto cu_n = cu_size_orig + 2;
+    auto cc_n = cc_size_orig + 2;
+    auto pr_n = pr_size_orig + 2;
+
+    ASSERT_EQ(get_wc_storage_size(), wc_n);
+    ASSERT_EQ(get_cu_storage_size(), cu_n);
+    ASSERT_EQ(get_cc_storage_size(), cc_n);
+    ASSERT_EQ(get_pr_storage_size(), pr_n);
+}
+
+//--------------------------------------------------------------------------------------//
+
 TEST_F(library_tests, add)
 {
     timemory_push_components("wall_clock, cpu_util");
@@ -35,6 +35,7 @@ TIMEMORY_TEST_DEFAULT_MAIN
 #include <future>
 #include <iostream>
 #include <iterator>
+#include <map>
 #include <random>
 #include <thread>
 #include <unordered_map>
@@ -437,3 +438,140 @@ TEST_F(mpi_tests, vector_get)
 }
 
 //--------------------------------------------------------------------------------------//
+
+TEST_F(mpi_tests, binary_gather)
+{
+    using bundle_t  = tim::component_tuple<wall_clock>;
+    using mpi_get_t = tim::operation::finalize::mpi_get<wall_clock, true>;
+
+    static_assert(mpi_get_t::supports_binary,
+                  "Error! wall_clock should support binary encoding");
+
+    constexpr size_t nrecords = 2000;
+    for(size_t i = 0; i < nrecords; ++i)
+    {
+        bundle_t _obj{ details::get_test_name() + "/" + std::to_string(i) };
+        _obj.start();
+        _obj.stop();
+    }
+
+    auto _collect = [](bool _binary, double& _elapsed) {
+        tim::settings::mpi_binary_gather() = _binary;
+        tim::mpi::barrier();
+        auto _beg = std::chrono::steady_clock::now();
+        auto _ret = tim::storage<wall_clock>::instance()->mpi_get();
+        auto _end = std::chrono::steady_clock::now();
+        _elapsed  = std::chrono::duration<double, std::milli>(_end - _beg).count();
+        return _ret;
+    };
+
+    double _json_time   = 0.0;
+    double _binary_time = 0.0;
+    auto   _json        = _collect(false, _json_time);
+    auto   _binary      = _collect(true, _binary_time);
+    tim::settings::mpi_binary_gather() = false;
+
+    if(tim::mpi::rank() != 0)
+    {
+        EXPECT_EQ(_binary.size(), 1);
+        return;
+    }
+
+    std::cout << "[" << details::get_test_name() << "]> " << tim::mpi::size()
+              << " ranks :: json + send/recv: " << _json_time
+              << " ms, binary + gatherv: " << _binary_time << " ms" << std::endl;
+
+    ASSERT_EQ(_json.size(), tim::mpi::size());
+    ASSERT_EQ(_binary.size(), _json.size());
+    for(size_t i = 0; i < _json.size(); ++i)
+    {
+        ASSERT_EQ(_binary.at(i).size(), _json.at(i).size()) << "rank " << i;
+        for(size_t j = 0; j < _json.at(i).size(); ++j)
+        {
+            const auto& _lhs = _json.at(i).at(j);
+            const auto& _rhs = _binary.at(i).at(j);
+            EXPECT_EQ(_lhs.prefix(), _rhs.prefix()) << "rank " << i;
+            EXPECT_EQ(_lhs.hash(), _rhs.hash()) << _lhs.prefix();
+            EXPECT_EQ(_lhs.depth(), _rhs.depth()) << _lhs.prefix();
+            EXPECT_EQ(_lhs.data().get_laps(), _rhs.data().get_laps()) << _lhs.prefix();
+            EXPECT_NEAR(_lhs.data().get(), _rhs.data().get(), 1.0e-9) << _lhs.prefix();
+            EXPECT_EQ(_lhs.stats().get_count(), _rhs.stats().get_count())
+                << _lhs.prefix();
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(mpi_tests, tree_reduction)
+{
+    using bundle_t = tim::component_tuple<wall_clock>;
+
+    constexpr size_t nrecords = 2000;
+    for(size_t i = 0; i < nrecords; ++i)
+    {
+        bundle_t _obj{ details::get_test_name() + "/" + std::to_string(i) };
+        _obj.start();
+        _obj.stop();
+    }
+
+    auto _node_count = tim::settings::node_count();
+    auto _collect    = [](bool _tree, double& _elapsed) {
+        tim::settings::node_count()         = 0;
+        tim::settings::collapse_processes() = true;
+        tim::settings::mpi_tree_reduction() = _tree;
+        tim::mpi::barrier();
+        auto _beg = std::chrono::steady_clock::now();
+        auto _ret = tim::storage<wall_clock>::instance()->mpi_get();
+        auto _end = std::chrono::steady_clock::now();
+        _elapsed  = std::chrono::duration<double, std::milli>(_end - _beg).count();
+        tim::settings::collapse_processes() = false;
+        tim::settings::mpi_tree_reduction() = false;
+        return _ret;
+    };
+
+    double _serial_time = 0.0;
+    double _tree_time   = 0.0;
+    auto   _serial      = _collect(false, _serial_time);
+    auto   _tree        = _collect(true, _tree_time);
+    tim::settings::node_count() = _node_count;
+
+    ASSERT_EQ(_tree.size(), 1);
+    if(tim::mpi::rank() != 0)
+        return;
+
+    std::cout << "[" << details::get_test_name() << "]> " << tim::mpi::size()
+              << " ranks :: collapse on rank 0: " << _serial_time
+              << " ms, tree reduction: " << _tree_time << " ms" << std::endl;
+
+    ASSERT_EQ(_serial.size(), 1);
+    ASSERT_EQ(_tree.front().size(), _serial.front().size());
+
+    auto _is_record = [](const std::string& _prefix) {
+        return _prefix.find(details::get_test_name() + "/") != std::string::npos;
+    };
+
+    std::map<std::string, const wall_clock*> _expected{};
+    for(const auto& itr : _serial.front())
+    {
+        if(_is_record(itr.prefix()))
+            _expected[itr.prefix()] = &itr.data();
+    }
+    ASSERT_EQ(_expected.size(), nrecords);
+
+    size_t _nfound = 0;
+    for(const auto& itr : _tree.front())
+    {
+        if(!_is_record(itr.prefix()))
+            continue;
+        auto eitr = _expected.find(itr.prefix());
+        ASSERT_TRUE(eitr != _expected.end()) << itr.prefix();
+        EXPECT_EQ(itr.data().get_laps(), tim::mpi::size()) << itr.prefix();
+        EXPECT_EQ(itr.data().get_laps(), eitr->second->get_laps()) << itr.prefix();
+        EXPECT_NEAR(itr.data().get(), eitr->second->get(), 1.0e-6) << itr.prefix();
+        ++_nfound;
+    }
+    EXPECT_EQ(_nfound, nrecords);
+}
+
+//--------------------------------------------------------------------------------------//
@@ -287,3 +287,27 @@ TEST_F(rusage_tests, current_peak_rss)
 }
 
 //--------------------------------------------------------------------------------------//
+
+TEST_F(rusage_tests, procfs_reader)
+{
+    const char _io[] = "rchar: 1234\nwchar: 56\nsyscr2: 7\nsyscw: 8\nread_bytes: 90\n"
+                       "write_bytes: 100\ncancelled_write_bytes: 0\n";
+    std::array<int64_t, 7> _values{};
+    ASSERT_EQ(tim::procfs::parse_integers(_io, sizeof(_io) - 1, _values.data(),
+                                          _values.size()),
+              7u);
+    EXPECT_EQ(_values, (std::array<int64_t, 7>{ 1234, 56, 7, 8, 90, 100, 0 }));
+
+#if defined(_LINUX)
+    // the descriptor is kept open between reads
+    std::array<int64_t, 2> _statm{};
+    EXPECT_EQ(tim::procfs::get_statm().read(_statm), 2u);
+    auto _fd = tim::procfs::get_statm().get_fd();
+    EXPECT_GE(_fd, 0);
+    EXPECT_GT(_statm.at(1), 0);
+    EXPECT_EQ(tim::procfs::get_statm().read(_statm), 2u);
+    EXPECT_EQ(tim::procfs::get_statm().get_fd(), _fd);
+#endif
+}
+
+//--------------------------------------------------------------------------------------//
@@ -0,0 +1,316 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "test_macros.hpp"
+
+TIMEMORY_TEST_DEFAULT_MAIN
+
+#include "gtest/gtest.h"
+
+#include "timemory/sampling/profiler.hpp"
+#include "timemory/sampling/sampler.hpp"
+#include "timemory/timemory.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace tim::component;
+using bundle_t  = tim::lightweight_tuple<wall_clock>;
+using sampler_t = tim::sampling::sampler<bundle_t, tim::sampling::dynamic, SIGPROF>;
+
+//--------------------------------------------------------------------------------------//
+
+namespace details
+{
+//  Get the current tests name
+inline std::string
+get_test_name()
+{
+    return std::string(::testing::UnitTest::GetInstance()->current_test_suite()->name()) +
+           "." + ::testing::UnitTest::GetInstance()->current_test_info()->name();
+}
+
+// consumes approximately "n" milliseconds of cpu-time of the calling thread
+inline void
+consume(long n)
+{
+    auto _get = []() {
+        struct timespec _ts;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &_ts);
+        return _ts.tv_sec * 1000000000L + _ts.tv_nsec;
+    };
+    auto _end = _get() + n * 1000000L;
+    while(_get() < _end)
+    {
+    }
+}
+
+// blocks until "n" threads have arrived
+struct barrier
+{
+    explicit barrier(size_t n)
+    : m_count(n)
+    {}
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> _lk(m_mutex);
+        if(--m_count == 0)
+            m_cv.notify_all();
+        else
+            m_cv.wait(_lk, [this]() { return m_count == 0; });
+    }
+
+private:
+    size_t                  m_count = 0;
+    std::mutex              m_mutex{};
+    std::condition_variable m_cv{};
+};
+
+// each thread creates a sampler, runs one of the functions and returns the number of
+// samples which were taken on the thread
+std::vector<size_t>
+run(const std::vector<std::function<void()>>& _funcs)
+{
+    auto                     _n = _funcs.size();
+    std::vector<size_t>      _count(_n, 0);
+    std::vector<std::thread> _threads{};
+    barrier                  _created{ _n + 1 };
+    barrier                  _configured{ _n + 1 };
+    barrier                  _stopped{ _n };
+
+    for(size_t i = 0; i < _n; ++i)
+    {
+        _threads.emplace_back([&, i]() {
+            sampler_t _sampler{ "thread", { SIGPROF } };
+            _created.wait();
+            _configured.wait();
+            _sampler.start();
+            _funcs.at(i)();
+            _sampler.stop();
+            _count.at(i) = _sampler.get_data().size() - 1;
+            // keep the instance registered until the other threads are done
+            _stopped.wait();
+        });
+    }
+
+    _created.wait();
+    sampler_t::configure(SIGPROF);
+    _configured.wait();
+
+    for(auto& itr : _threads)
+        itr.join();
+
+    sampler_t::ignore({ SIGPROF });
+    sampler_t::clear();
+    return _count;
+}
+}  // namespace details
+
+//--------------------------------------------------------------------------------------//
+
+class sampler_tests : public ::testing::Test
+{
+protected:
+    TIMEMORY_TEST_DEFAULT_SUITE_SETUP
+    TIMEMORY_TEST_DEFAULT_SUITE_TEARDOWN
+
+    void SetUp() override
+    {
+        sampler_t::set_delay(0.01);
+        sampler_t::set_frequency(0.01);
+    }
+
+    void TearDown() override { sampler_t::set_per_thread(false); }
+};
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(sampler_tests, per_thread_cpu_time)
+{
+    ASSERT_TRUE(sampler_t::set_per_thread(true, CLOCK_THREAD_CPUTIME_ID));
+
+    // the last thread only sleeps so it should not be sampled
+    auto _count = details::run(
+        { []() { details::consume(500); }, []() { details::consume(250); },
+          []() { std::this_thread::sleep_for(std::chrono::milliseconds(250)); } });
+
+    std::cout << details::get_test_name() << " samples:";
+    for(auto& itr : _count)
+        std::cout << " " << itr;
+    std::cout << std::endl;
+
+    // 500 ms and 250 ms of cpu-time at 10 ms intervals
+    EXPECT_GE(_count.at(0), 25) << "too few samples";
+    EXPECT_GE(_count.at(1), 12) << "too few samples";
+    EXPECT_LE(_count.at(2), 1) << "sleeping thread was sampled";
+
+    double _ratio = static_cast<double>(_count.at(0)) / std::max<size_t>(_count.at(1), 1);
+    EXPECT_NEAR(_ratio, 2.0, 0.6);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(sampler_tests, per_thread_monotonic)
+{
+    ASSERT_TRUE(sampler_t::set_per_thread(true, CLOCK_MONOTONIC));
+
+    // with a real-time clock, sleeping threads are sampled as well
+    auto _count = details::run(
+        { []() { std::this_thread::sleep_for(std::chrono::milliseconds(400)); },
+          []() { std::this_thread::sleep_for(std::chrono::milliseconds(200)); } });
+
+    std::cout << details::get_test_name() << " samples: " << _count.at(0) << " "
+              << _count.at(1) << std::endl;
+
+    EXPECT_GE(_count.at(0), 20) << "too few samples";
+    EXPECT_GE(_count.at(1), 10) << "too few samples";
+
+    double _ratio = static_cast<double>(_count.at(0)) / std::max<size_t>(_count.at(1), 1);
+    EXPECT_NEAR(_ratio, 2.0, 0.6);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(sampler_tests, buffered)
+{
+    // cpu-time timers are limited by the scheduler tick so use a real-time clock at
+    // ~1 kHz and a ring which would overflow without the drain thread
+    ASSERT_TRUE(sampler_t::set_per_thread(true, CLOCK_MONOTONIC));
+    sampler_t::set_delay(0.001);
+    sampler_t::set_frequency(0.001);
+    sampler_t::start_drain(0.005);
+
+    sampler_t _sampler{ "buffered", { SIGPROF } };
+    _sampler.enable_buffer(64);
+    ASSERT_NE(_sampler.get_buffer(), nullptr);
+    EXPECT_EQ(_sampler.get_buffer()->capacity(), 64);
+
+    _sampler.start();
+    details::consume(300);
+    _sampler.stop();
+    sampler_t::stop_drain();
+    sampler_t::clear();
+
+    auto&  _data    = _sampler.get_data();
+    auto   _count   = _data.size() - 1;
+    auto   _dropped = _sampler.get_buffer()->dropped();
+    size_t _ordered = 0;
+    for(size_t i = 1; i < _count; ++i)
+    {
+        auto _prev = _data.at(i - 1).get<wall_clock>()->get_value();
+        auto _curr = _data.at(i).get<wall_clock>()->get_value();
+        if(_prev > 0 && _curr > _prev)
+            ++_ordered;
+    }
+
+    std::cout << details::get_test_name() << " samples: " << _count
+              << ", dropped: " << _dropped << std::endl;
+
+    // the record of each sample is the wall-clock timestamp of the interrupt
+    EXPECT_GE(_count, 200) << "too few samples";
+    EXPECT_EQ(_ordered + 1, _count) << "samples are not in order";
+    EXPECT_TRUE(_sampler.get_buffer()->empty());
+    EXPECT_LE(_dropped, _count / 10);
+}
+
+//--------------------------------------------------------------------------------------//
+
+namespace details
+{
+TIMEMORY_NOINLINE void
+profiled_a(long n)
+{
+    consume(n);
+}
+
+TIMEMORY_NOINLINE void
+profiled_b(long n)
+{
+    consume(n);
+}
+}  // namespace details
+
+TEST_F(sampler_tests, profiler)
+{
+    using profiler_t = tim::sampling::profiler<>;
+
+    profiler_t::configure(200.0);
+    profiler_t _profiler{};
+    _profiler.start();
+    details::profiled_a(400);
+    details::profiled_b(200);
+    _profiler.stop();
+
+    uint64_t _a = 0;
+    uint64_t _b = 0;
+    for(const auto& itr : _profiler.get_stacks())
+    {
+        for(const auto& nitr : _profiler.get_names(itr.second.stack))
+        {
+            if(nitr.find("profiled_a") != std::string::npos)
+                _a += itr.second.count;
+            else if(nitr.find("profiled_b") != std::string::npos)
+                _b += itr.second.count;
+        }
+    }
+
+    std::cout << details::get_test_name() << " samples: " << _profiler.get_samples()
+              << ", stacks: " << _profiler.get_stacks().size() << ", a: " << _a
+              << ", b: " << _b << std::endl;
+
+    std::stringstream _folded{};
+    _profiler.write_folded(_folded);
+
+    EXPECT_GE(_profiler.get_samples(), 40) << "too few samples";
+    EXPECT_LT(_profiler.get_stacks().size(), _profiler.get_samples());
+    EXPECT_GT(_b, 0);
+    EXPECT_NEAR(static_cast<double>(_a) / std::max<uint64_t>(_b, 1), 2.0, 0.6);
+    EXPECT_NE(_folded.str().find("profiled_a"), std::string::npos);
+
+    // the call-tree below [sampling] in the wall-clock storage
+    auto _total = _profiler.aggregate();
+    EXPECT_EQ(_total, _profiler.get_samples());
+    EXPECT_EQ(_profiler.aggregate(), 0);
+
+    int64_t _sampled = 0;
+    int64_t _found   = 0;
+    for(const auto& itr : tim::storage<wall_clock>::instance()->get())
+    {
+        if(itr.prefix().find("[sampling]") != std::string::npos)
+            _sampled = itr.data().get_laps();
+        if(itr.prefix().find("profiled_a") != std::string::npos)
+            _found += itr.data().get_laps();
+    }
+    EXPECT_EQ(_sampled, static_cast<int64_t>(_total));
+    EXPECT_EQ(_found, static_cast<int64_t>(_a));
+}
+
+//--------------------------------------------------------------------------------------//
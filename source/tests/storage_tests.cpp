@@ -0,0 +1,880 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "test_macros.hpp"
+
+TIMEMORY_TEST_DEFAULT_MAIN
+
+#include "timemory/storage/node_id_map.hpp"
+#include "timemory/storage/pointer_stack.hpp"
+#include "timemory/timemory.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace tim::component;
+
+//--------------------------------------------------------------------------------------//
+
+namespace details
+{
+//--------------------------------------------------------------------------------------//
+//  Get the current tests name
+//
+inline std::string
+get_test_name()
+{
+    return std::string(::testing::UnitTest::GetInstance()->current_test_suite()->name()) +
+           "." + ::testing::UnitTest::GetInstance()->current_test_info()->name();
+}
+
+// generates a set of (depth, hash) keys resembling a call-graph
+inline auto
+get_keys(size_t n, int64_t max_depth = 16)
+{
+    std::mt19937_64                        _rng{ 54561434UL };
+    std::uniform_int_distribution<int64_t> _dist{ 0, max_depth };
+    std::vector<std::pair<int64_t, int64_t>> _keys{};
+    _keys.reserve(n);
+    for(size_t i = 0; i < n; ++i)
+        _keys.emplace_back(_dist(_rng), static_cast<int64_t>(_rng()));
+    return _keys;
+}
+
+// returns the nanoseconds per iteration of the function
+template <typename FuncT>
+inline double
+time_per_op(size_t n, FuncT&& _func)
+{
+    auto _beg = std::chrono::steady_clock::now();
+    _func();
+    auto _end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(_end - _beg).count() / n;
+}
+}  // namespace details
+
+//--------------------------------------------------------------------------------------//
+
+class storage_tests : public ::testing::Test
+{
+protected:
+    TIMEMORY_TEST_DEFAULT_SUITE_BODY
+};
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(storage_tests, node_id_map)
+{
+    auto _keys = details::get_keys(10000);
+
+    tim::node_id_map<size_t> _map{};
+    for(size_t i = 0; i < _keys.size(); ++i)
+        _map.insert(_keys.at(i).first, _keys.at(i).second, i);
+
+    EXPECT_EQ(_map.size(), _keys.size());
+    for(size_t i = 0; i < _keys.size(); ++i)
+    {
+        auto* _val = _map.find(_keys.at(i).first, _keys.at(i).second);
+        ASSERT_TRUE(_val != nullptr) << "index " << i;
+        EXPECT_EQ(*_val, i);
+    }
+
+    // same hash at a different depth is a different entry
+    EXPECT_TRUE(_map.find(_keys.front().first + 100, _keys.front().second) == nullptr);
+
+    // erase every other entry and make sure the rest are still found
+    for(size_t i = 0; i < _keys.size(); i += 2)
+        EXPECT_TRUE(_map.erase(_keys.at(i).first, _keys.at(i).second));
+
+    EXPECT_EQ(_map.size(), _keys.size() / 2);
+    for(size_t i = 0; i < _keys.size(); ++i)
+    {
+        auto* _val = _map.find(_keys.at(i).first, _keys.at(i).second);
+        if(i % 2 == 0)
+        {
+            EXPECT_TRUE(_val == nullptr) << "index " << i;
+        }
+        else
+        {
+            ASSERT_TRUE(_val != nullptr) << "index " << i;
+            EXPECT_EQ(*_val, i);
+        }
+    }
+
+    size_t _n = 0;
+    _map.for_each([&_n](int64_t, int64_t, size_t _v) {
+        EXPECT_EQ(_v % 2, 1);
+        ++_n;
+    });
+    EXPECT_EQ(_n, _map.size());
+
+    _map.clear();
+    EXPECT_TRUE(_map.empty());
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(storage_tests, node_id_map_insert_cost)
+{
+    using nested_map_t =
+        std::unordered_map<int64_t, std::unordered_map<int64_t, uintptr_t>>;
+
+    constexpr size_t nrepeat = 20;
+    constexpr size_t nkeys   = 4096;
+    auto             _keys   = details::get_keys(nkeys);
+    uintptr_t        _sum    = 0;
+
+    // mimics the storage access pattern: mostly lookups of existing call-sites
+    auto _nested = details::time_per_op(nkeys * nrepeat, [&]() {
+        nested_map_t _map{};
+        for(size_t j = 0; j < nrepeat; ++j)
+        {
+            for(const auto& itr : _keys)
+            {
+                auto _existing = _map[itr.first].find(itr.second);
+                if(_existing != _map[itr.first].end())
+                    _sum += _existing->second;
+                else
+                    _map[itr.first][itr.second] = j + 1;
+            }
+        }
+    });
+
+    auto _flat = details::time_per_op(nkeys * nrepeat, [&]() {
+        tim::node_id_map<uintptr_t> _map{};
+        for(size_t j = 0; j < nrepeat; ++j)
+        {
+            for(const auto& itr : _keys)
+            {
+                auto* _existing = _map.find(itr.first, itr.second);
+                if(_existing)
+                    _sum += *_existing;
+                else
+                    _map.insert(itr.first, itr.second, j + 1);
+            }
+        }
+    });
+
+    std::cout << std::setprecision(3) << std::fixed << "[" << details::get_test_name()
+              << "]> nested unordered_map: " << _nested
+              << " ns/insert, node_id_map: " << _flat << " ns/insert (checksum: " << _sum
+              << ")" << std::endl;
+
+    // generous bound to avoid spurious failures on loaded CI machines
+    EXPECT_LT(_flat, 2.0 * _nested);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(storage_tests, reset)
+{
+    using bundle_t = tim::component_tuple<wall_clock>;
+
+    for(int i = 0; i < 4; ++i)
+    {
+        bundle_t _obj{ details::get_test_name() + "/" + std::to_string(i) };
+        _obj.start();
+        _obj.stop();
+    }
+
+    auto* _storage = tim::storage<wall_clock>::instance();
+    ASSERT_TRUE(_storage != nullptr);
+    EXPECT_GE(_storage->size(), 4);
+    EXPECT_GE(_storage->get_node_ids().size(), 5);
+
+    _storage->reset();
+    EXPECT_EQ(_storage->size(), 0);
+    EXPECT_EQ(_storage->get_node_ids().size(), 1);
+    EXPECT_TRUE(_storage->get_node_ids().contains(0, 0));
+
+    bundle_t _obj{ details::get_test_name() };
+    _obj.start();
+    _obj.stop();
+    EXPECT_EQ(_storage->size(), 1);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(storage_tests, pointer_stack)
+{
+    std::array<int, 8>      _data{};
+    tim::pointer_stack<int> _stack{};
+    auto                    _capacity = _stack.capacity();
+
+    for(int j = 0; j < 100; ++j)
+    {
+        for(auto& itr : _data)
+            _stack.push(&itr);
+        EXPECT_EQ(_stack.size(), _data.size());
+        // LIFO
+        for(size_t i = _data.size(); i > 0; --i)
+            EXPECT_TRUE(_stack.pop(&_data.at(i - 1)));
+        EXPECT_TRUE(_stack.empty());
+    }
+
+    // push/pop of a stack smaller than the initial capacity never reallocates
+    EXPECT_EQ(_stack.capacity(), _capacity);
+
+    // out-of-order
+    for(auto& itr : _data)
+        _stack.push(&itr);
+    EXPECT_TRUE(_stack.pop(&_data.at(2)));
+    EXPECT_FALSE(_stack.pop(&_data.at(2)));
+    EXPECT_FALSE(_stack.contains(&_data.at(2)));
+    EXPECT_TRUE(_stack.pop(&_data.at(0)));
+    EXPECT_EQ(_stack.size(), _data.size() - 2);
+    for(size_t i = _data.size(); i > 0; --i)
+    {
+        if(i - 1 == 2 || i - 1 == 0)
+            continue;
+        EXPECT_EQ(*(_stack.end() - 1), &_data.at(i - 1));
+        EXPECT_TRUE(_stack.pop(&_data.at(i - 1)));
+    }
+    EXPECT_TRUE(_stack.empty());
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(storage_tests, graph_allocator)
+{
+    using node_t  = tim::tgraph_node<int64_t>;
+    using alloc_t = tim::graph_allocator<node_t>;
+    using graph_t = tim::graph<int64_t, alloc_t>;
+
+    alloc_t              _alloc{};
+    std::vector<node_t*> _nodes{};
+    for(int i = 0; i < 1000; ++i)
+        _nodes.emplace_back(_alloc.allocate(1));
+    // slots are recycled through the free-list
+    auto _nchunks = _alloc.num_chunks();
+    for(auto* itr : _nodes)
+        _alloc.deallocate(itr, 1);
+    for(auto& itr : _nodes)
+        itr = _alloc.allocate(1);
+    EXPECT_EQ(_alloc.num_chunks(), _nchunks);
+    _alloc.release();
+    EXPECT_EQ(_alloc.num_chunks(), 0);
+    EXPECT_EQ(_alloc.alloc_bytes(), 0);
+
+    graph_t _graph{};
+    auto    _head = _graph.set_head(-1);
+    auto    _cur  = _head;
+    for(int64_t i = 0; i < 10000; ++i)
+    {
+        _cur = _graph.append_child(_cur, i);
+        if(i % 8 == 7)
+            _cur = _head;
+    }
+    EXPECT_EQ(_graph.size(), 10001);
+
+    // moves transfer the node memory w/ the nodes
+    graph_t _moved{ std::move(_graph) };
+    EXPECT_EQ(_moved.size(), 10001);
+    EXPECT_EQ(_graph.size(), 0);
+
+    // copies allocate their own nodes
+    graph_t _copy{ _moved };
+    EXPECT_EQ(_copy.size(), 10001);
+    _moved.clear();
+    EXPECT_EQ(_moved.size(), 0);
+    int64_t _sum = 0;
+    for(auto itr = _copy.begin(); itr != _copy.end(); ++itr)
+        _sum += *itr;
+    EXPECT_EQ(_sum, -1 + (9999 * 10000) / 2);
+
+    // splicing a graph into another takes ownership of the spliced nodes
+    graph_t _other{};
+    auto    _other_head = _other.set_head(100);
+    _other.append_child(_other_head, 101);
+    _copy.move_in_as_nth_child(_copy.begin(), 0, _other);
+    EXPECT_EQ(_other.size(), 0);
+    EXPECT_EQ(_copy.size(), 10003);
+    _other.clear();
+    _sum = 0;
+    for(auto itr = _copy.begin(); itr != _copy.end(); ++itr)
+        _sum += *itr;
+    EXPECT_EQ(_sum, 200 + (9999 * 10000) / 2);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(storage_tests, graph_allocator_cost)
+{
+    using std_graph_t  = tim::graph<int64_t, std::allocator<tim::tgraph_node<int64_t>>>;
+    using slab_graph_t = tim::graph<int64_t>;
+
+    constexpr size_t nrepeat = 10;
+    constexpr size_t nnodes  = 50000;
+    int64_t          _sum    = 0;
+
+    // mimics a call-graph: descend a few levels and then return to the head
+    auto _build = [](auto& _graph) {
+        auto _head = _graph.set_head(0);
+        auto _cur  = _head;
+        for(size_t i = 0; i < nnodes; ++i)
+        {
+            _cur = _graph.append_child(_cur, static_cast<int64_t>(i));
+            if(i % 5 == 4)
+                _cur = _head;
+        }
+    };
+
+    auto _traverse = [&_sum](auto& _graph) {
+        for(auto itr = _graph.begin(); itr != _graph.end(); ++itr)
+            _sum += *itr;
+    };
+
+    auto _measure = [&](auto& _graph, double& _insert, double& _iterate) {
+        _insert = details::time_per_op(nnodes * nrepeat, [&]() {
+            for(size_t j = 0; j < nrepeat; ++j)
+            {
+                _graph.clear();
+                _build(_graph);
+            }
+        });
+        _iterate = details::time_per_op(nnodes * nrepeat, [&]() {
+            for(size_t j = 0; j < nrepeat; ++j)
+                _traverse(_graph);
+        });
+    };
+
+    std_graph_t  _std_graph{};
+    slab_graph_t _slab_graph{};
+    double       _std_insert   = 0.0;
+    double       _std_iterate  = 0.0;
+    double       _slab_insert  = 0.0;
+    double       _slab_iterate = 0.0;
+
+    _measure(_std_graph, _std_insert, _std_iterate);
+    _measure(_slab_graph, _slab_insert, _slab_iterate);
+
+    std::cout << std::setprecision(3) << std::fixed << "[" << details::get_test_name()
+              << "]> std::allocator: " << _std_insert << " ns/insert, " << _std_iterate
+              << " ns/node pre-order :: graph_allocator: " << _slab_insert
+              << " ns/insert, " << _slab_iterate << " ns/node pre-order (checksum: "
+              << _sum << ")" << std::endl;
+
+    EXPECT_EQ(_std_graph.size(), _slab_graph.size());
+    // generous bound to avoid spurious failures on loaded CI machines
+    EXPECT_LT(_slab_insert, 2.0 * _std_insert);
+    EXPECT_LT(_slab_iterate, 2.0 * _std_iterate);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(storage_tests, hash_ids)
+{
+    constexpr size_t nthreads = 8;
+    constexpr size_t nlabels  = 1000;
+
+    auto _prefix = details::get_test_name() + "/label-";
+    auto _label  = [&_prefix](size_t i) { return _prefix + std::to_string(i); };
+
+    std::vector<std::thread> _threads{};
+    for(size_t i = 0; i < nthreads; ++i)
+    {
+        _threads.emplace_back([&, i]() {
+            // every thread registers the same labels + some of its own
+            for(size_t j = 0; j < nlabels; ++j)
+                tim::add_hash_id(_label(j));
+            tim::add_hash_id(_label(nlabels + i));
+        });
+    }
+    for(auto& itr : _threads)
+        itr.join();
+
+    // all threads share one instance so the main thread sees every label
+    for(size_t i = 0; i < nlabels + nthreads; ++i)
+    {
+        auto _hash = tim::get_hash_id(_label(i));
+        EXPECT_EQ(tim::get_hash_identifier(_hash), _label(i));
+    }
+
+    size_t _n = 0;
+    tim::get_hash_ids()->for_each([&_n, &_prefix](const auto& itr) {
+        if(itr.second.find(_prefix) == 0)
+            ++_n;
+    });
+    EXPECT_EQ(_n, nlabels + nthreads);
+
+    // worker threads use the same instance as the main thread
+    auto*       _main   = tim::get_hash_ids().get();
+    const void* _worker = nullptr;
+    std::thread{ [&_worker]() { _worker = tim::get_hash_ids().get(); } }.join();
+    EXPECT_EQ(_main, _worker);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(storage_tests, hash_ids_contention)
+{
+    using locked_map_t = std::unordered_map<tim::hash_value_type, std::string>;
+
+    constexpr size_t nthreads = 8;
+    constexpr size_t nrepeat  = 50;
+    constexpr size_t nlabels  = 512;
+
+    std::vector<std::string> _labels{};
+    for(size_t i = 0; i < nlabels; ++i)
+        _labels.emplace_back(details::get_test_name() + "/" + std::to_string(i));
+
+    // mimics many threads registering the same labels when components are created
+    auto _run = [&](auto&& _add) {
+        std::vector<std::thread> _threads{};
+        for(size_t i = 0; i < nthreads; ++i)
+        {
+            _threads.emplace_back([&]() {
+                for(size_t j = 0; j < nrepeat; ++j)
+                    for(const auto& itr : _labels)
+                        _add(itr);
+            });
+        }
+        for(auto& itr : _threads)
+            itr.join();
+    };
+
+    locked_map_t _locked_map{};
+    std::mutex   _mutex{};
+    auto         _locked = details::time_per_op(nthreads * nrepeat * nlabels, [&]() {
+        _run([&](const std::string& _v) {
+            auto                        _hash = tim::get_hash_id(_v);
+            std::lock_guard<std::mutex> _lk{ _mutex };
+            if(_locked_map.find(_hash) == _locked_map.end())
+                _locked_map.emplace(_hash, _v);
+        });
+    });
+
+    auto _shared_map = std::make_shared<tim::graph_hash_map_t>();
+    auto _sharded    = details::time_per_op(nthreads * nrepeat * nlabels, [&]() {
+        _run([&](const std::string& _v) { tim::add_hash_id(_shared_map, _v); });
+    });
+
+    std::cout << std::setprecision(3) << std::fixed << "[" << details::get_test_name()
+              << "]> " << nthreads << " threads :: mutex + unordered_map: " << _locked
+              << " ns/label, concurrent_hash_map: " << _sharded << " ns/label"
+              << std::endl;
+
+    EXPECT_EQ(_locked_map.size(), nlabels);
+    EXPECT_EQ(_shared_map->size(), nlabels);
+    // generous bound to avoid spurious failures on loaded CI machines
+    EXPECT_LT(_sharded, 2.0 * _locked);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(storage_tests, hash_literal)
+{
+    constexpr auto _hash = tim::get_hash_id("storage_tests/hash_literal");
+    static_assert(_hash == tim::fnv1a_hash("storage_tests/hash_literal"),
+                  "Error! hash of string literal not computed at compile-time");
+
+    // compile-time hash must match the hash of the same label computed at runtime
+    std::string _label = "storage_tests/hash_literal";
+    EXPECT_EQ(_hash, tim::get_hash_id(_label));
+    EXPECT_EQ(_hash, tim::get_hash_id(_label.c_str()));
+    EXPECT_EQ(tim::get_hash_id(""), tim::get_hash_id(std::string{}));
+
+    // registered with the identifier the first time it is used
+    EXPECT_EQ(TIMEMORY_HASH_LITERAL("storage_tests/hash_literal"), _hash);
+    EXPECT_EQ(tim::get_hash_identifier(_hash), _label);
+
+    // ids computed externally w/ std::hash resolve via an alias
+    auto _ext = std::hash<std::string>{}(_label);
+    if(_ext != _hash)
+        tim::add_hash_id(_hash, _ext);
+    EXPECT_EQ(tim::get_hash_id(tim::get_hash_aliases(), _ext), _hash);
+    EXPECT_EQ(tim::get_hash_identifier(_ext), _label);
+
+    constexpr size_t nitr = 1000000;
+
+    auto _runtime = details::time_per_op(nitr, [&]() {
+        for(size_t i = 0; i < nitr; ++i)
+            tim::consume_parameters(tim::add_hash_id("storage_tests/hash_literal"));
+    });
+    auto _literal = details::time_per_op(nitr, [&]() {
+        for(size_t i = 0; i < nitr; ++i)
+            tim::consume_parameters(TIMEMORY_HASH_LITERAL("storage_tests/hash_literal"));
+    });
+
+    std::cout << std::setprecision(3) << std::fixed << "[" << details::get_test_name()
+              << "]> add_hash_id: " << _runtime
+              << " ns/label, TIMEMORY_HASH_LITERAL: " << _literal << " ns/label"
+              << std::endl;
+
+    EXPECT_LT(_literal, _runtime);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(storage_tests, parallel_merge)
+{
+    using bundle_t  = tim::component_tuple<trip_count>;
+    using storage_t = tim::storage<trip_count>;
+    using merge_t   = tim::operation::finalize::merge<trip_count, true>;
+    using key_t     = std::pair<int64_t, std::string>;
+    using value_t   = std::pair<size_t, int64_t>;
+    using result_t  = std::map<key_t, value_t>;
+
+    constexpr size_t ngroups   = 3;
+    constexpr size_t nthreads  = 5;
+    constexpr size_t nrepeat   = 100;
+    constexpr size_t nchildren = 32;
+
+    auto _name = details::get_test_name();
+
+    // worker threads record while the master is at a different location in each group
+    // and then stay alive until the master has merged them
+    auto _run = [&](size_t _merge_threads, double& _elapsed) {
+        auto* _master = storage_t::instance();
+        _master->reset();
+
+        std::mutex               _mutex{};
+        std::condition_variable  _cv{};
+        size_t                   _nready  = 0;
+        bool                     _release = false;
+        std::vector<std::thread> _threads{};
+        std::vector<merge_t::storage_type*> _workers{};
+
+        auto _record = [&](size_t _idx) {
+            for(size_t i = 0; i < nrepeat; ++i)
+            {
+                bundle_t _outer{ _name + "/outer" };
+                _outer.start();
+                for(size_t j = 0; j < nchildren; ++j)
+                {
+                    bundle_t _inner{ _name + "/inner-" + std::to_string(j) };
+                    _inner.start();
+                    if(j % (_idx + 1) == 0)
+                    {
+                        bundle_t _leaf{ _name + "/leaf-" + std::to_string(_idx % 4) };
+                        _leaf.start();
+                        _leaf.stop();
+                    }
+                    _inner.stop();
+                }
+                _outer.stop();
+            }
+            std::unique_lock<std::mutex> _lk{ _mutex };
+            _workers.emplace_back(storage_t::instance());
+            ++_nready;
+            _cv.notify_all();
+            _cv.wait(_lk, [&_release]() { return _release; });
+        };
+
+        for(size_t g = 0; g < ngroups; ++g)
+        {
+            bundle_t _region{ _name + "/group-" + std::to_string(g) };
+            _region.start();
+            for(size_t i = 0; i < nthreads; ++i)
+                _threads.emplace_back(_record, g * nthreads + i);
+            std::unique_lock<std::mutex> _lk{ _mutex };
+            _cv.wait(_lk, [&]() { return _nready == (g + 1) * nthreads; });
+            _lk.unlock();
+            _region.stop();
+        }
+
+        _elapsed = details::time_per_op(1, [&]() {
+            if(_merge_threads > 1)
+                merge_t{ *_master, _workers, _merge_threads };
+            else
+            {
+                for(auto& itr : _workers)
+                    merge_t{ *_master, *itr };
+            }
+        });
+
+        result_t _ret{};
+        for(const auto& itr : _master->get())
+        {
+            auto& _v = _ret[key_t{ itr.depth(), itr.prefix() }];
+            _v.first += 1;
+            _v.second += itr.data().get_laps();
+        }
+
+        {
+            std::unique_lock<std::mutex> _lk{ _mutex };
+            _release = true;
+        }
+        _cv.notify_all();
+        for(auto& itr : _threads)
+            itr.join();
+
+        return _ret;
+    };
+
+    double _serial_time   = 0.0;
+    double _parallel_time = 0.0;
+    auto   _serial        = _run(1, _serial_time);
+    auto   _parallel      = _run(4, _parallel_time);
+
+    std::cout << std::setprecision(3) << std::fixed << "[" << details::get_test_name()
+              << "]> " << (ngroups * nthreads) << " threads :: serial merge: "
+              << (_serial_time * 1.0e-6) << " ms, tree merge: "
+              << (_parallel_time * 1.0e-6) << " ms" << std::endl;
+
+    EXPECT_FALSE(_serial.empty());
+    EXPECT_EQ(_serial.size(), _parallel.size());
+    for(const auto& itr : _serial)
+    {
+        auto pitr = _parallel.find(itr.first);
+        ASSERT_TRUE(pitr != _parallel.end()) << itr.first.second;
+        EXPECT_EQ(pitr->second.first, itr.second.first) << itr.first.second;
+        EXPECT_EQ(pitr->second.second, itr.second.second) << itr.first.second;
+    }
+    storage_t::instance()->reset();
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(storage_tests, basic_tree_merge)
+{
+    using graph_node_t = tim::node::graph<trip_count>;
+    using tree_node_t  = tim::node::tree<trip_count>;
+    using tree_t       = tim::basic_tree<tree_node_t>;
+    using tree_vec_t   = std::vector<tree_t>;
+    using merge_t      = tim::operation::finalize::merge<trip_count, true>;
+
+    // a root with a wide fan-out, e.g. many functions called from main
+    auto _make = [](size_t _width, uint64_t _offset) {
+        trip_count _obj{};
+        _obj.start();
+        tree_t _root{};
+        _root.get_value() = tree_node_t{ graph_node_t{ 1, _obj, 0, 0, 0, false } };
+        for(size_t i = 0; i < _width; ++i)
+        {
+            auto _child         = std::make_shared<tree_t>();
+            _child->get_value() =
+                tree_node_t{ graph_node_t{ 100 + _offset + i, _obj, 1, 0, 0, false } };
+            _root.get_children().emplace_back(std::move(_child));
+        }
+        return tree_vec_t{ _root };
+    };
+
+    // half of the rhs children match lhs children
+    auto _run = [&_make](size_t _width, double& _cost) {
+        auto       _lhs = _make(_width, 0);
+        auto       _rhs = _make(_width, _width / 2);
+        tree_vec_t _ret{};
+        _cost = details::time_per_op(_width, [&]() { _ret = merge_t{}(_lhs, _rhs); });
+        return _ret;
+    };
+
+    double _narrow_cost = 0.0;
+    double _wide_cost   = 0.0;
+    auto   _narrow      = _run(256, _narrow_cost);
+    auto   _wide        = _run(8192, _wide_cost);
+
+    std::cout << std::setprecision(3) << std::fixed << "[" << details::get_test_name()
+              << "]> 256 children: " << _narrow_cost
+              << " ns/child, 8192 children: " << _wide_cost << " ns/child" << std::endl;
+
+    for(auto& itr : { std::make_pair(&_narrow, 256), std::make_pair(&_wide, 8192) })
+    {
+        auto& _ret   = *itr.first;
+        auto  _width = static_cast<size_t>(itr.second);
+        ASSERT_EQ(_ret.size(), 1);
+        EXPECT_EQ(_ret.front().get_value().inclusive().data().get(), 2);
+        auto& _children = _ret.front().get_children();
+        ASSERT_EQ(_children.size(), _width + _width / 2);
+
+        int64_t _nmerged = 0;
+        int64_t _total   = 0;
+        for(const auto& citr : _children)
+        {
+            auto _v = citr->get_value().inclusive().data().get();
+            _nmerged += (_v == 2) ? 1 : 0;
+            _total += _v;
+        }
+        EXPECT_EQ(_nmerged, _width / 2);
+        EXPECT_EQ(_total, 2 * _width);
+    }
+
+    // quadratic matching would increase the per-child cost ~32x
+    EXPECT_LT(_wide_cost, 8.0 * _narrow_cost);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(storage_tests, snapshot)
+{
+    using bundle_t   = tim::component_tuple<trip_count>;
+    using storage_t  = tim::storage<trip_count>;
+    using snapshot_t = tim::operation::finalize::snapshot<trip_count, true>;
+    using result_t   = typename snapshot_t::result_type;
+
+    auto  _name   = details::get_test_name();
+    auto* _master = storage_t::instance();
+    _master->reset();
+
+    std::mutex              _mutex{};
+    std::condition_variable _cv{};
+    std::atomic<bool>       _done{ false };
+    std::atomic<int64_t>    _count{ 0 };
+    bool                    _stopped = false;
+    bool                    _release = false;
+
+    // the worker keeps inserting nodes while the master takes the snapshots and then
+    // stays alive so that its call-graph is not merged into the master
+    std::thread _worker{ [&]() {
+        while(!_done)
+        {
+            bundle_t _outer{ _name + "/outer" };
+            _outer.start();
+            bundle_t _inner{ _name + "/inner-" + std::to_string(_count % 64) };
+            _inner.start();
+            _inner.stop();
+            _outer.stop();
+            ++_count;
+        }
+        std::unique_lock<std::mutex> _lk{ _mutex };
+        _stopped = true;
+        _cv.notify_all();
+        _cv.wait(_lk, [&_release]() { return _release; });
+    } };
+
+    auto _get_laps = [&_name](const result_t& _results) {
+        int64_t _laps = 0;
+        for(const auto& itr : _results)
+        {
+            if(itr.prefix().find(_name + "/outer") != std::string::npos)
+                _laps += itr.data().get_laps();
+        }
+        return _laps;
+    };
+
+    while(_count < 100)
+        std::this_thread::sleep_for(std::chrono::microseconds{ 100 });
+
+    int64_t _prev = 0;
+    for(int i = 0; i < 10; ++i)
+    {
+        result_t _results{};
+        snapshot_t{ *_master }(_results);
+        auto _laps = _get_laps(_results);
+        EXPECT_GE(_laps, _prev);
+        _prev = _laps;
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+    }
+    EXPECT_GT(_prev, 0);
+
+    _done = true;
+    {
+        std::unique_lock<std::mutex> _lk{ _mutex };
+        _cv.wait(_lk, [&_stopped]() { return _stopped; });
+    }
+
+    result_t _first{};
+    snapshot_t{ *_master }(_first);
+    EXPECT_EQ(_get_laps(_first), _count.load());
+
+    // the delta between two snapshots only contains the data recorded in between
+    for(int64_t i = 0; i < 10; ++i)
+    {
+        bundle_t _outer{ _name + "/outer" };
+        _outer.start();
+        _outer.stop();
+    }
+
+    result_t _second{};
+    snapshot_t{ *_master }(_second);
+    EXPECT_EQ(_get_laps(_second), _count.load() + 10);
+    EXPECT_EQ(_get_laps(snapshot_t::subtract(_second, _first)), 10);
+
+    {
+        std::unique_lock<std::mutex> _lk{ _mutex };
+        _release = true;
+    }
+    _cv.notify_all();
+    _worker.join();
+    storage_t::instance()->reset();
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(storage_tests, overhead_compensation)
+{
+    using bundle_t           = tim::component_tuple<wall_clock>;
+    constexpr int64_t nchild = 100;
+
+    auto _parent_label = details::get_test_name();
+    auto _child_label  = details::get_test_name() + "/child";
+
+    bundle_t _parent{ _parent_label };
+    _parent.start();
+    for(int64_t i = 0; i < nchild; ++i)
+    {
+        bundle_t _child{ _child_label };
+        _child.start();
+        _child.stop();
+    }
+    _parent.stop();
+
+    auto _cost = tim::storage<wall_clock>::get_calibrated_overhead().get_accum();
+    EXPECT_GT(_cost, 0);
+    EXPECT_EQ(_cost, tim::storage<wall_clock>::get_calibrated_overhead().get_accum());
+
+    auto* _storage   = tim::storage<wall_clock>::instance();
+    auto  _find_node = [_storage](const std::string& _label) {
+        for(auto& itr : _storage->graph())
+        {
+            if(tim::get_hash_identifier(itr.id()) == _label)
+                return &itr.obj();
+        }
+        return static_cast<wall_clock*>(nullptr);
+    };
+
+    auto* _parent_obj = _find_node(_parent_label);
+    auto* _child_obj  = _find_node(_child_label);
+    ASSERT_TRUE(_parent_obj != nullptr);
+    ASSERT_TRUE(_child_obj != nullptr);
+    EXPECT_EQ(_child_obj->get_laps(), nchild);
+
+    auto _parent_accum = _parent_obj->get_accum();
+    auto _child_accum  = _child_obj->get_accum();
+
+    _storage->compensate_overhead();
+
+    // the children have no descendants
+    EXPECT_EQ(_child_obj->get_accum(), _child_accum);
+    EXPECT_EQ(_parent_obj->get_accum(),
+              std::max<int64_t>(_parent_accum - nchild * _cost, 0));
+    EXPECT_EQ(_parent_obj->get_laps(), 1);
+
+    std::cout << "calibrated overhead: " << _cost << " nsec, parent: " << _parent_accum
+              << " -> " << _parent_obj->get_accum() << " nsec" << std::endl;
+}
+
+//--------------------------------------------------------------------------------------//
@@ -151,21 +151,27 @@ TEST_F(throttle_tests, multithreaded)
 {
     tim::settings::debug() = false;
     std::array<bool, nthreads> is_throttled;
+    std::array<bool, nthreads> is_expensive_throttled;
     is_throttled.fill(false);
+    is_expensive_throttled.fill(true);
 
-    auto _run = [&is_throttled](uint64_t idx) {
+    auto name           = details::get_test_name();
+    auto expensive_name = name + "/expensive";
+
+    // only the even threads call the cheap function but the throttling decision is
+    // shared so the odd threads must also see it as throttled
+    auto _run = [&](uint64_t idx) {
         timemory_push_trace("thread");
-        auto name = details::get_test_name();
-        auto n    = 2 * tim::settings::throttle_count();
-        auto v    = 2 * tim::settings::throttle_value();
+        auto n = 2 * tim::settings::throttle_count();
+        auto v = 2 * tim::settings::throttle_value();
         if(idx % 2 == 1)
         {
             for(size_t i = 0; i < n; ++i)
             {
-                timemory_push_trace(name.c_str());
+                timemory_push_trace(expensive_name.c_str());
                 // details::do_sleep(v);
                 details::consume(v);
-                timemory_pop_trace(name.c_str());
+                timemory_pop_trace(expensive_name.c_str());
             }
         }
         else
@@ -177,7 +183,6 @@ TEST_F(throttle_tests, multithreaded)
             }
         }
         timemory_pop_trace("thread");
-        is_throttled.at(idx) = timemory_is_throttled(name.c_str());
     };
 
     std::vector<std::thread> threads;
@@ -186,13 +191,73 @@ TEST_F(throttle_tests, multithreaded)
     for(auto& itr : threads)
         itr.join();
 
+    threads.clear();
+    for(uint64_t i = 0; i < nthreads; ++i)
+    {
+        threads.emplace_back(
+            [&](uint64_t idx) {
+                is_throttled.at(idx) = timemory_is_throttled(name.c_str());
+                is_expensive_throttled.at(idx) =
+                    timemory_is_throttled(expensive_name.c_str());
+            },
+            i);
+    }
+    for(auto& itr : threads)
+        itr.join();
+
     for(uint64_t i = 0; i < nthreads; ++i)
     {
-        bool _answer = (i % 2 == 1) ? false : true;
         std::cout << "thread " << i << " throttling: " << std::boolalpha
-                  << is_throttled[i] << std::endl;
-        EXPECT_TRUE(is_throttled[i] == _answer);
+                  << is_throttled[i] << " (cheap), " << is_expensive_throttled[i]
+                  << " (expensive)" << std::endl;
+        EXPECT_TRUE(is_throttled[i]);
+        EXPECT_FALSE(is_expensive_throttled[i]);
+    }
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(throttle_tests, resample)
+{
+    tim::settings::debug() = false;
+    auto name              = details::get_test_name();
+    auto cheap_name        = name + "/cheap";
+    auto n                 = 2 * tim::settings::throttle_count();
+    auto v                 = 4 * tim::settings::throttle_value();
+    auto r                 = tim::settings::throttle_resample();
+
+    // without re-sampling, a throttled function is never measured again
+    tim::settings::throttle_resample() = 0;
+    for(size_t i = 0; i < n; ++i)
+    {
+        timemory_push_trace(name.c_str());
+        timemory_pop_trace(name.c_str());
+    }
+    EXPECT_TRUE(timemory_is_throttled(name.c_str()));
+
+    for(size_t i = 0; i < tim::settings::throttle_count() / 10; ++i)
+    {
+        timemory_push_trace(name.c_str());
+        details::consume(v);
+        timemory_pop_trace(name.c_str());
+    }
+    EXPECT_TRUE(timemory_is_throttled(name.c_str()));
+
+    // with re-sampling, the function becoming expensive un-throttles it while a cheap
+    // function is throttled again
+    tim::settings::throttle_resample() = 100;
+    for(size_t i = 0; i < n + 100; ++i)
+    {
+        timemory_push_trace(name.c_str());
+        details::consume(v);
+        timemory_pop_trace(name.c_str());
+        timemory_push_trace(cheap_name.c_str());
+        timemory_pop_trace(cheap_name.c_str());
     }
+    tim::settings::throttle_resample() = r;
+
+    EXPECT_FALSE(timemory_is_throttled(name.c_str()));
+    EXPECT_TRUE(timemory_is_throttled(cheap_name.c_str()));
 }
 
 //--------------------------------------------------------------------------------------//
@@ -29,11 +29,13 @@ TIMEMORY_TEST_DEFAULT_MAIN
 #include "gtest/gtest.h"
 
 #include "timemory/timemory.hpp"
+#include "timemory/tpls/cereal/cereal/external/rapidjson/document.h"
 
 using namespace tim::component;
 
 #include <chrono>
 #include <condition_variable>
+#include <fstream>
 #include <iostream>
 #include <mutex>
 #include <random>
@@ -117,6 +119,18 @@ consume(long n)
         try_lk.try_lock();
 }
 
+// every call is a separate timeline entry nested within the caller
+inline long
+fibonacci_timeline(long n)
+{
+    using bundle_t = tim::component_tuple<monotonic_clock>;
+    bundle_t _obj{ "fibonacci", true, tim::scope::tree{} + tim::scope::timeline{} };
+    _obj.start();
+    auto _ret = (n < 2) ? n : (fibonacci_timeline(n - 1) + fibonacci_timeline(n - 2));
+    _obj.stop();
+    return _ret;
+}
+
 // get a random entry from vector
 template <typename Tp>
 size_t
@@ -308,3 +322,107 @@ TEST_F(timeline_tests, nested)
 }
 
 //--------------------------------------------------------------------------------------//
+
+TEST_F(timeline_tests, buffered)
+{
+    auto _storage = tim::storage<monotonic_clock>::instance();
+    auto _run     = [&_storage](size_t _buffer_size, const std::string& _spill_path) {
+        tim::settings::timeline_buffer_size() = _buffer_size;
+        tim::settings::timeline_spill_path()  = _spill_path;
+        _storage->reset();
+        EXPECT_EQ(details::fibonacci_timeline(5), 5);
+        // buffered entries are not inserted until the data is requested
+        if(_buffer_size > 0)
+            EXPECT_EQ(_storage->size(), 0);
+        return _storage->get();
+    };
+
+    // 15 calls
+    auto _expected = _run(0, "");
+    auto _buffered = _run(1000, "");
+    auto _spilled  = _run(4, ".");
+    auto _dropped  = _run(4, "");
+
+    tim::settings::timeline_buffer_size() = 0;
+    tim::settings::timeline_spill_path()  = "";
+    _storage->reset();
+
+    ASSERT_EQ(_expected.size(), 15);
+    ASSERT_EQ(_buffered.size(), _expected.size());
+    ASSERT_EQ(_spilled.size(), _expected.size());
+    // the buffer holds one chunk of 4 events so the 12 oldest are discarded
+    EXPECT_EQ(_dropped.size(), 3);
+
+    for(size_t i = 0; i < _expected.size(); ++i)
+    {
+        EXPECT_EQ(_buffered.at(i).prefix(), _expected.at(i).prefix()) << " index " << i;
+        EXPECT_EQ(_buffered.at(i).depth(), _expected.at(i).depth()) << " index " << i;
+        EXPECT_EQ(_buffered.at(i).data().get_laps(), 1) << " index " << i;
+        EXPECT_EQ(_spilled.at(i).prefix(), _expected.at(i).prefix()) << " index " << i;
+        EXPECT_EQ(_spilled.at(i).depth(), _expected.at(i).depth()) << " index " << i;
+    }
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(timeline_tests, buffered_trace)
+{
+    using storage_type = tim::storage<monotonic_clock>;
+    namespace rapidjson = TIMEMORY_CEREAL_RAPIDJSON_NAMESPACE;
+
+    tim::settings::file_output()          = true;
+    tim::settings::timeline_trace()       = true;
+    tim::settings::timeline_buffer_size() = 4;
+    auto _storage                         = storage_type::instance();
+    _storage->reset();
+
+    // 15 calls, 12 are written when the chunks fill up and 3 when the data is requested
+    details::fibonacci_timeline(5);
+    _storage->get();
+    storage_type::close_timeline_trace();
+
+    tim::settings::file_output()          = false;
+    tim::settings::timeline_trace()       = false;
+    tim::settings::timeline_buffer_size() = 0;
+    _storage->reset();
+
+    auto _fname = tim::settings::compose_output_filename(
+        monotonic_clock::get_label() + std::string(".timeline"), ".json");
+    std::ifstream _ifs{ _fname };
+    ASSERT_TRUE(_ifs) << _fname;
+    std::string _json{ std::istreambuf_iterator<char>{ _ifs },
+                       std::istreambuf_iterator<char>{} };
+
+    rapidjson::Document _doc{};
+    _doc.Parse(_json.c_str());
+    ASSERT_FALSE(_doc.HasParseError()) << _json;
+    ASSERT_TRUE(_doc.HasMember("traceEvents"));
+    const auto& _events = _doc["traceEvents"];
+    ASSERT_TRUE(_events.IsArray());
+    ASSERT_EQ(_events.Size(), 15);
+
+    double _beg = std::numeric_limits<double>::max();
+    double _end = 0.0;
+    for(const auto& itr : _events.GetArray())
+    {
+        EXPECT_STREQ(itr["name"].GetString(), "fibonacci");
+        EXPECT_STREQ(itr["ph"].GetString(), "X");
+        EXPECT_TRUE(itr["pid"].IsInt64());
+        EXPECT_TRUE(itr["tid"].IsInt64());
+        EXPECT_GE(itr["dur"].GetDouble(), 0.0);
+        _beg = std::min(_beg, itr["ts"].GetDouble());
+        _end = std::max(_end, itr["ts"].GetDouble() + itr["dur"].GetDouble());
+    }
+
+    // the outermost call encloses all the others (within the rounding to nanoseconds)
+    bool _found = false;
+    for(const auto& itr : _events.GetArray())
+    {
+        if(itr["ts"].GetDouble() == _beg &&
+           itr["ts"].GetDouble() + itr["dur"].GetDouble() > _end - 0.002)
+            _found = true;
+    }
+    EXPECT_TRUE(_found);
+}
+
+//--------------------------------------------------------------------------------------//
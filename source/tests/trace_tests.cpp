@@ -266,3 +266,60 @@ TEST_F(trace_tests, modify_components)
 }
 
 //--------------------------------------------------------------------------------------//
+
+TEST_F(trace_tests, push_pop_throughput)
+{
+    tim::component::user_trace_bundle::reset();
+    tim::component::user_trace_bundle::configure<wall_clock>();
+
+    // register aliased ids the same way timemory-run instrumented binaries do
+    std::vector<std::string> _names = {};
+    std::vector<uint64_t>    _ids   = {};
+    std::vector<const char*> _cstrs = {};
+    for(size_t i = 0; i < 16; ++i)
+        _names.emplace_back(details::get_test_name() + "/func_" + std::to_string(i));
+    for(auto& itr : _names)
+    {
+        _ids.emplace_back(std::hash<std::string>{}(itr));
+        _cstrs.emplace_back(itr.c_str());
+    }
+    timemory_add_hash_ids(_ids.size(), _ids.data(), _cstrs.data());
+
+    // disable throttling so every event is timed
+    auto t                          = tim::settings::throttle_value();
+    tim::settings::throttle_value() = 0;
+
+    const size_t nitr = 20000;
+    auto         _beg = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < nitr; ++i)
+    {
+        for(auto& itr : _ids)
+            timemory_push_trace_hash(itr);
+        for(auto itr = _ids.rbegin(); itr != _ids.rend(); ++itr)
+            timemory_pop_trace_hash(*itr);
+    }
+    auto _end = std::chrono::steady_clock::now();
+
+    tim::settings::throttle_value() = t;
+
+    double _sec    = std::chrono::duration<double>(_end - _beg).count();
+    double _events = 2.0 * nitr * _ids.size();
+    printf("[%s]> %.0f push/pop events in %.3f sec = %.3e events/sec (%.1f ns/event)\n",
+           details::get_test_name().c_str(), _events, _sec, _events / _sec,
+           1.0e9 * _sec / _events);
+
+    for(auto& itr : _names)
+        EXPECT_FALSE(timemory_is_throttled(itr.c_str())) << itr;
+
+    auto _wc = tim::storage<wall_clock>::instance()->get();
+    for(auto& itr : _names)
+    {
+        auto _match = [&itr](const auto& _v) {
+            return _v.prefix().find(itr) != std::string::npos &&
+                   _v.data().get_laps() == static_cast<int64_t>(nitr);
+        };
+        EXPECT_EQ(std::count_if(_wc.begin(), _wc.end(), _match), 1) << itr;
+    }
+}
+
+//--------------------------------------------------------------------------------------//
@@ -38,7 +38,10 @@
 #include "timemory/utility/utility.hpp"
 
 #include <cstdint>
+#include <limits>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 #if defined(TIMEMORY_USE_MPI)
 #    include <mpi.h>
@@ -498,6 +501,25 @@ get_node_index()
     return rank() / get_num_ranks_per_node();
 }
 
+//--------------------------------------------------------------------------------------//
+/// returns a communicator containing the first rank of each node (ordered by the
+/// rank in the world communicator). On the other ranks, the communicator contains all
+/// the remaining ranks and should not be used
+inline comm_t
+get_node_head_comm()
+{
+    if(!is_initialized())
+        return comm_world_v;
+    auto _get_head_comm = []() {
+        comm_t head_comm;
+        int    color = (rank(get_node_comm()) == 0) ? 0 : 1;
+        comm_split(mpi::comm_world_v, color, rank(mpi::comm_world_v), &head_comm);
+        return head_comm;
+    };
+    static comm_t _instance = _get_head_comm();
+    return _instance;
+}
+
 //--------------------------------------------------------------------------------------//
 
 inline void
@@ -559,6 +581,57 @@ gather(const void* sendbuf, int sendcount, data_type_t sendtype, void* recvbuf,
 #endif
 }
 
+//--------------------------------------------------------------------------------------//
+/// gathers the string from every rank onto the root rank with a single MPI_Gatherv.
+/// On the root, \param _data is resized to the number of ranks. Returns false (and
+/// gathers nothing) when the combined size exceeds what MPI_Gatherv can address, in
+/// which case the caller should fall back to \ref send and \ref recv
+inline bool
+gather(const std::string& str, std::vector<std::string>& _data, int root,
+       comm_t comm = mpi::comm_world_v)
+{
+#if defined(TIMEMORY_USE_MPI)
+    if(!is_initialized())
+    {
+        _data = std::vector<std::string>(1, str);
+        return true;
+    }
+
+    int       _rank  = rank(comm);
+    int       _size  = size(comm);
+    long long _len   = str.size();
+    long long _total = 0;
+    TIMEMORY_MPI_ERROR_CHECK(
+        MPI_Allreduce(&_len, &_total, 1, MPI_LONG_LONG, MPI_SUM, comm));
+    if(_total > static_cast<long long>(std::numeric_limits<int>::max()))
+        return false;
+
+    int              _count = static_cast<int>(_len);
+    std::vector<int> _counts((_rank == root) ? _size : 0, 0);
+    TIMEMORY_MPI_ERROR_CHECK(
+        MPI_Gather(&_count, 1, MPI_INT, _counts.data(), 1, MPI_INT, root, comm));
+
+    std::vector<int> _displs(_counts.size(), 0);
+    for(size_t i = 1; i < _counts.size(); ++i)
+        _displs.at(i) = _displs.at(i - 1) + _counts.at(i - 1);
+
+    std::vector<char> _buffer((_rank == root) ? _total : 0);
+    TIMEMORY_MPI_ERROR_CHECK(MPI_Gatherv(const_cast<char*>(str.data()), _count,
+                                         MPI_CHAR, _buffer.data(), _counts.data(),
+                                         _displs.data(), MPI_CHAR, root, comm));
+
+    _data.clear();
+    _data.reserve(_counts.size());
+    for(size_t i = 0; i < _counts.size(); ++i)
+        _data.emplace_back(_buffer.data() + _displs.at(i), _counts.at(i));
+    return true;
+#else
+    consume_parameters(root, comm);
+    _data = std::vector<std::string>(1, str);
+    return true;
+#endif
+}
+
 //--------------------------------------------------------------------------------------//
 
 inline void
@@ -0,0 +1,202 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/** \file backends/procfs.hpp
+ * \headerfile backends/procfs.hpp "timemory/backends/procfs.hpp"
+ * Allocation-free readers of the files in /proc/<pid> of the target process
+ *
+ */
+
+#pragma once
+
+#include "timemory/backends/process.hpp"
+#include "timemory/macros/os.hpp"
+#include "timemory/utility/macros.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+#if defined(_LINUX)
+#    include <fcntl.h>
+#    include <unistd.h>
+#endif
+
+namespace tim
+{
+namespace procfs
+{
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \fn size_t tim::procfs::parse_integers(const char*, size_t, int64_t*, size_t)
+/// \brief Stores up to \param _n unsigned integers found in the first \param _len
+/// characters of \param _buf into \param _out, skipping everything else (e.g. the labels
+/// of /proc/<pid>/io). Returns the number of integers
+///
+inline size_t
+parse_integers(const char* _buf, size_t _len, int64_t* _out, size_t _n) noexcept
+{
+    size_t _count = 0;
+    size_t i      = 0;
+    while(i < _len && _count < _n)
+    {
+        // skip to the next number which is not part of a word (e.g. "syscr2")
+        if(_buf[i] < '0' || _buf[i] > '9' ||
+           (i > 0 && ((_buf[i - 1] >= 'a' && _buf[i - 1] <= 'z') ||
+                      (_buf[i - 1] >= 'A' && _buf[i - 1] <= 'Z') || _buf[i - 1] == '_')))
+        {
+            ++i;
+            continue;
+        }
+        int64_t _value = 0;
+        for(; i < _len && _buf[i] >= '0' && _buf[i] <= '9'; ++i)
+            _value = (_value * 10) + (_buf[i] - '0');
+        _out[_count++] = _value;
+    }
+    return _count;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \class tim::procfs::reader
+/// \brief Keeps /proc/<pid>/<name> of \ref process::get_target_id open and re-reads it
+/// from the beginning with pread into a stack buffer, i.e. one system call and no heap
+/// allocation per read. The file is re-opened when the target process changes; the
+/// previous descriptor is kept open until the reader is destroyed since other threads
+/// may still be reading it.
+///
+class reader
+{
+public:
+    static constexpr size_t buffer_size = 1024;
+
+    explicit reader(const char* _name)
+    : m_name{ _name }
+    {}
+
+    ~reader()
+    {
+#if defined(_LINUX)
+        for(auto itr : m_retired)
+            ::close(itr);
+        if(m_fd >= 0)
+            ::close(m_fd);
+#endif
+    }
+
+    reader(const reader&) = delete;
+    reader(reader&&)      = delete;
+    reader& operator=(const reader&) = delete;
+    reader& operator=(reader&&) = delete;
+
+    /// reads the first N integers of the file. Returns the number of values which were
+    /// read, the others are set to zero
+    template <size_t N>
+    size_t read(std::array<int64_t, N>& _data)
+    {
+        _data.fill(0);
+#if defined(_LINUX)
+        int _fd = get_fd();
+        if(_fd < 0)
+            return 0;
+        char    _buf[buffer_size];
+        ssize_t _len = ::pread(_fd, _buf, sizeof(_buf), 0);
+        if(_len <= 0)
+            return 0;
+        return parse_integers(_buf, static_cast<size_t>(_len), _data.data(), N);
+#else
+        return 0;
+#endif
+    }
+
+    /// the descriptor of the file of the current target process, -1 if it cannot be
+    /// opened
+    int get_fd()
+    {
+#if defined(_LINUX)
+        auto _pid = process::get_target_id();
+        if(m_pid.load(std::memory_order_acquire) == _pid)
+            return m_fd.load(std::memory_order_acquire);
+
+        std::unique_lock<std::mutex> _lk{ m_mutex };
+        if(m_pid.load(std::memory_order_acquire) == _pid)
+            return m_fd.load(std::memory_order_acquire);
+
+        char _path[64];
+        snprintf(_path, sizeof(_path), "/proc/%li/%s", (long) _pid, m_name);
+        int _fd  = ::open(_path, O_RDONLY | O_CLOEXEC);
+        int _old = m_fd.exchange(_fd, std::memory_order_acq_rel);
+        if(_old >= 0)
+            m_retired.emplace_back(_old);
+        m_pid.store(_pid, std::memory_order_release);
+        return _fd;
+#else
+        return -1;
+#endif
+    }
+
+private:
+    const char*                  m_name    = nullptr;
+    std::atomic<int>             m_fd{ -1 };
+    std::atomic<process::id_t>   m_pid{ static_cast<process::id_t>(-1) };
+    std::mutex                   m_mutex   = {};
+    std::vector<int>             m_retired = {};
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \fn reader& tim::procfs::get_statm()
+/// \brief /proc/<pid>/statm: size resident shared text lib data dt (in pages). The
+/// instance is never destroyed so that it can be used in static destructors
+///
+inline reader&
+get_statm()
+{
+    static auto* _instance = new reader{ "statm" };
+    return *_instance;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \fn reader& tim::procfs::get_io()
+/// \brief /proc/<pid>/io: rchar wchar syscr syscw read_bytes write_bytes
+/// cancelled_write_bytes
+///
+inline reader&
+get_io()
+{
+    static auto* _instance = new reader{ "io" };
+    return *_instance;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+}  // namespace procfs
+}  // namespace tim
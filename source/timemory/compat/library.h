@@ -80,7 +80,7 @@ extern "C"
 #endif  // if defined(__cplusplus)
 
     /// \fn uint64_t timemory_get_unique_id(void)
-    /// Returns a unique integer for a thread.
+    /// Returns a unique integer.
     extern uint64_t timemory_get_unique_id(void) TIMEMORY_VISIBLE;
 
     /// \fn void timemory_create_record(const char* name, uint64_t* id, int n, int* ct)
@@ -98,7 +98,9 @@ extern "C"
                                        int* ct) TIMEMORY_VISIBLE;
 
     /// \fn void timemory_delete_record(uint64_t nid)
-    /// Deletes the record created by \ref timemory_create_record.
+    /// Deletes the record created by \ref timemory_create_record. The record may be
+    /// deleted on a different thread than the one which created it and ids which were
+    /// already deleted are ignored.
     extern void timemory_delete_record(uint64_t nid) TIMEMORY_VISIBLE;
 
     /// \fn bool timemory_library_is_initialized(void)
@@ -262,6 +264,36 @@ extern "C"
     /// \endcode
     extern void timemory_pop_region(const char* name) TIMEMORY_VISIBLE;
 
+    /// \fn uint64_t timemory_register_region(const char* name)
+    /// \param [in] name label for region
+    ///
+    /// Returns a handle for the region label which is valid on every thread. Pushing
+    /// and popping the region by the handle avoids looking up the label on each call.
+    ///
+    /// \code{.cpp}
+    /// static uint64_t foo_region = timemory_register_region("foo");
+    ///
+    /// void foo()
+    /// {
+    ///     timemory_push_region_handle(foo_region);
+    ///     // ...
+    ///     timemory_pop_region_handle(foo_region);
+    /// }
+    /// \endcode
+    extern uint64_t timemory_register_region(const char* name) TIMEMORY_VISIBLE;
+
+    /// \fn void timemory_push_region_handle(uint64_t handle)
+    /// \param [in] handle value returned by \ref timemory_register_region
+    ///
+    /// Starts collection of components for the region.
+    extern void timemory_push_region_handle(uint64_t handle) TIMEMORY_VISIBLE;
+
+    /// \fn void timemory_pop_region_handle(uint64_t handle)
+    /// \param [in] handle value returned by \ref timemory_register_region
+    ///
+    /// Stops collection of components for the region.
+    extern void timemory_pop_region_handle(uint64_t handle) TIMEMORY_VISIBLE;
+
     extern void        c_timemory_init(int argc, char** argv,
                                        timemory_settings) TIMEMORY_VISIBLE;
     extern void        c_timemory_finalize(void) TIMEMORY_VISIBLE;
@@ -31,6 +31,7 @@
 #pragma once
 
 #include "timemory/backends/process.hpp"
+#include "timemory/backends/procfs.hpp"
 #include "timemory/mpl/apply.hpp"
 #include "timemory/utility/macros.hpp"
 #include "timemory/utility/types.hpp"
@@ -86,11 +87,19 @@ struct io_cache
         return _data;
     }
 
+    /// reads the first NumReads values through the persistent descriptor of
+    /// \ref tim::procfs::get_io, i.e. without opening the file or allocating
     template <size_t NumReads = 6, size_t N>
     static inline auto& read(std::array<int64_t, N>& _data)
     {
-        std::ifstream ifs(get_filename().c_str());
-        _data = read(ifs, _data, std::make_index_sequence<NumReads>{});
+        static_assert(NumReads <= 6, "Error! Only six entries in the /proc/<PID>/io");
+        static_assert(NumReads > 0, "Error! Number of reads is zero");
+        static_assert(NumReads <= N,
+                      "Error! Number of indexes to read exceeds the array size");
+        std::array<int64_t, NumReads> _values{};
+        procfs::get_io().read(_values);
+        for(size_t i = 0; i < NumReads; ++i)
+            _data[i] = _values[i];
         return _data;
     }
 
@@ -26,10 +26,12 @@
 #pragma once
 
 #include "timemory/backends/process.hpp"
+#include "timemory/backends/procfs.hpp"
 #include "timemory/macros/os.hpp"
 #include "timemory/units.hpp"
 #include "timemory/utility/macros.hpp"
 
+#include <array>
 #include <cstdint>
 #include <cstdio>
 #include <fstream>
@@ -367,20 +369,9 @@ tim::get_page_rss()
 
 #    else  // Linux
 
-    int64_t           rss = 0;
-    std::stringstream fio;
-    fio << "/proc/" << get_rusage_pid() << "/statm";
-    FILE* fp = fopen(fio.str().c_str(), "r");
-    if(fp && fscanf(fp, "%*s%ld", &rss) == 1)
-    {
-        fclose(fp);
-        return static_cast<int64_t>(rss * units::get_page_size());
-    }
-
-    if(fp)
-        fclose(fp);
-
-    return static_cast<int64_t>(0);
+    std::array<int64_t, 2> _statm{};
+    procfs::get_statm().read(_statm);
+    return static_cast<int64_t>(_statm[1] * units::get_page_size());
 
 #    endif
 #elif defined(_WINDOWS)
@@ -434,21 +425,9 @@ tim::get_data_rss()
 
 #    else  // Linux
 
-    std::string fstatm = [&]() {
-        std::stringstream fio;
-        fio << "/proc/" << get_rusage_pid() << "/statm";
-        return fio.str();
-    }();
-    int64_t       drss_size = 0;
-    std::ifstream ifs;
-    ifs.open(fstatm.c_str());
-    if(ifs)
-    {
-        static int64_t dummy = 0;
-        ifs >> dummy >> dummy >> dummy >> dummy >> dummy >> drss_size;
-    }
-    ifs.close();
-    return static_cast<int64_t>(drss_size * units::get_page_size());
+    std::array<int64_t, 6> _statm{};
+    procfs::get_statm().read(_statm);
+    return static_cast<int64_t>(_statm[5] * units::get_page_size());
 #    endif
 #else
     return static_cast<int64_t>(0);
@@ -637,18 +616,9 @@ tim::get_virt_mem()
                (long int) get_rusage_pid());
 #        endif
 
-    std::string fstatm = [&]() {
-        std::stringstream fio;
-        fio << "/proc/" << get_rusage_pid() << "/statm";
-        return fio.str();
-    }();
-    int64_t       vm_size = 0;
-    std::ifstream ifs;
-    ifs.open(fstatm.c_str());
-    if(ifs)
-        ifs >> vm_size;
-    ifs.close();
-    return static_cast<int64_t>(vm_size * units::get_page_size());
+    std::array<int64_t, 1> _statm{};
+    procfs::get_statm().read(_statm);
+    return static_cast<int64_t>(_statm[0] * units::get_page_size());
 
 #    endif
 #elif defined(_WINDOWS)
@@ -88,10 +88,8 @@ struct peak_rss : public base<peak_rss>
     /// stop a measurement using the cached data
     void stop(const cache_type& _cache)
     {
-        auto tmp   = record(_cache);
-        auto delta = tmp - value;
-        accum      = std::max(static_cast<const value_type&>(accum), delta);
-        value      = tmp;
+        value = (record(_cache) - value);
+        accum += value;
     }
 };
 
@@ -170,9 +168,8 @@ struct num_io_in : public base<num_io_in>
 
     void stop(const cache_type& _cache)
     {
-        auto tmp = record(_cache);
-        accum += (tmp - value);
-        value = tmp;
+        value = (record(_cache) - value);
+        accum += value;
     }
 };
 
@@ -215,9 +212,8 @@ struct num_io_out : public base<num_io_out>
 
     void stop(const cache_type& _cache)
     {
-        auto tmp = record(_cache);
-        accum += (tmp - value);
-        value = tmp;
+        value = (record(_cache) - value);
+        accum += value;
     }
 };
 
@@ -265,9 +261,8 @@ struct num_minor_page_faults : public base<num_minor_page_faults>
 
     void stop(const cache_type& _cache)
     {
-        auto tmp = record(_cache);
-        accum += (tmp - value);
-        value = tmp;
+        value = (record(_cache) - value);
+        accum += value;
     }
 };
 
@@ -313,9 +308,8 @@ struct num_major_page_faults : public base<num_major_page_faults>
 
     void stop(const cache_type& _cache)
     {
-        auto tmp = record(_cache);
-        accum += (tmp - value);
-        value = tmp;
+        value = (record(_cache) - value);
+        accum += value;
     }
 };
 
@@ -364,9 +358,8 @@ struct voluntary_context_switch : public base<voluntary_context_switch>
 
     void stop(const cache_type& _cache)
     {
-        auto tmp = record(_cache);
-        accum += (tmp - value);
-        value = tmp;
+        value = (record(_cache) - value);
+        accum += value;
     }
 };
 
@@ -416,9 +409,8 @@ struct priority_context_switch : public base<priority_context_switch>
 
     void stop(const cache_type& _cache)
     {
-        auto tmp = record(_cache);
-        accum += (tmp - value);
-        value = tmp;
+        value = (record(_cache) - value);
+        accum += value;
     }
 };
 
@@ -501,8 +493,8 @@ struct user_mode_time : public base<user_mode_time, int64_t>
         auto tmp = record(_cache);
         if(tmp > value)
         {
-            accum += (tmp - value);
-            value = tmp;
+            value = (tmp - value);
+            accum += value;
         }
     }
 };
@@ -556,8 +548,8 @@ struct kernel_mode_time : public base<kernel_mode_time, int64_t>
         auto tmp = record(_cache);
         if(tmp > value)
         {
-            accum += (tmp - value);
-            value = tmp;
+            value = (tmp - value);
+            accum += value;
         }
     }
 };
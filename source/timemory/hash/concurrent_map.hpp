@@ -0,0 +1,301 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/**
+ * \file timemory/hash/concurrent_map.hpp
+ * \brief Process-wide, sharded, insert-only hash map w/ lock-free lookups
+ */
+
+#pragma once
+
+#include "timemory/macros/attributes.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace tim
+{
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \class tim::concurrent_hash_map
+/// \tparam KeyT Key type
+/// \tparam MappedT Mapped type
+/// \tparam NumShards Number of independently locked shards (must be a power of two)
+///
+/// \brief Insert-only hash map which is shared by all threads. Each shard is an
+/// open-addressing table of pointers to heap-allocated entries: lookups never lock
+/// (they only perform acquire loads) and insertions only lock the shard the key maps to.
+/// When a shard grows, the previous table is retired but not freed until the map is
+/// destroyed so that concurrent readers never probe freed memory. Entries are never
+/// moved or modified after insertion so the pointers returned by \ref find remain valid
+/// for the lifetime of the map.
+template <typename KeyT, typename MappedT, size_t NumShards = 64>
+class concurrent_hash_map
+{
+    static_assert((NumShards & (NumShards - 1)) == 0,
+                  "Number of shards must be a power of two");
+
+public:
+    using this_type      = concurrent_hash_map<KeyT, MappedT, NumShards>;
+    using key_type       = KeyT;
+    using mapped_type    = MappedT;
+    using value_type     = std::pair<const KeyT, MappedT>;
+    using size_type      = size_t;
+    using iterator       = const value_type*;
+    using const_iterator = const value_type*;
+
+private:
+    using slot_type = std::atomic<value_type*>;
+
+    struct table_type
+    {
+        explicit table_type(size_t _capacity)
+        : mask{ _capacity - 1 }
+        , slots{ new slot_type[_capacity] }
+        {
+            for(size_t i = 0; i < _capacity; ++i)
+                slots[i].store(nullptr, std::memory_order_relaxed);
+        }
+
+        TIMEMORY_NODISCARD size_t capacity() const { return mask + 1; }
+
+        size_t                       mask  = 0;
+        std::unique_ptr<slot_type[]> slots = {};
+    };
+
+    struct shard_type
+    {
+        mutable std::mutex                       mutex{};
+        std::atomic<table_type*>                 table{ nullptr };
+        size_t                                   size    = 0;
+        std::vector<std::unique_ptr<table_type>> tables  = {};
+        std::vector<std::unique_ptr<value_type>> entries = {};
+    };
+
+public:
+    concurrent_hash_map() = default;
+    ~concurrent_hash_map() { clear(); }
+
+    concurrent_hash_map(const this_type& rhs)
+    {
+        rhs.for_each([this](const value_type& itr) { insert(itr); });
+    }
+
+    this_type& operator=(const this_type& rhs)
+    {
+        if(this != &rhs)
+        {
+            clear();
+            rhs.for_each([this](const value_type& itr) { insert(itr); });
+        }
+        return *this;
+    }
+
+    concurrent_hash_map(this_type&&) = delete;
+    this_type& operator=(this_type&&) = delete;
+
+    /// returns nullptr (i.e. \ref end) if the key does not exist. Does not lock.
+    TIMEMORY_NODISCARD const_iterator find(const KeyT& _key) const
+    {
+        auto        _hash  = get_hash(_key);
+        const auto& _shard = get_shard(_hash);
+        auto*       _table = _shard.table.load(std::memory_order_acquire);
+        return (_table) ? probe(_table, _hash, _key) : nullptr;
+    }
+
+    TIMEMORY_NODISCARD size_type count(const KeyT& _key) const
+    {
+        return (find(_key) != nullptr) ? 1 : 0;
+    }
+
+    TIMEMORY_NODISCARD static constexpr const_iterator end() { return nullptr; }
+
+    /// inserts the key if it does not exist. If it does exist, the existing entry is
+    /// not modified. Returns the entry and whether the insertion took place
+    template <typename... Args>
+    std::pair<const_iterator, bool> emplace(const KeyT& _key, Args&&... _args)
+    {
+        auto  _hash  = get_hash(_key);
+        auto& _shard = get_shard(_hash);
+
+        // fast path: already exists
+        auto* _table = _shard.table.load(std::memory_order_acquire);
+        if(_table)
+        {
+            auto* _existing = probe(_table, _hash, _key);
+            if(_existing)
+                return { _existing, false };
+        }
+
+        std::lock_guard<std::mutex> _lk{ _shard.mutex };
+
+        // check again w/ the lock held
+        _table = _shard.table.load(std::memory_order_relaxed);
+        if(_table)
+        {
+            auto* _existing = probe(_table, _hash, _key);
+            if(_existing)
+                return { _existing, false };
+        }
+
+        // keep the load factor at or below 0.5 so probes always terminate quickly
+        if(!_table || 2 * (_shard.size + 1) > _table->capacity())
+            _table = grow(_shard);
+
+        _shard.entries.emplace_back(std::unique_ptr<value_type>{ new value_type(
+            std::piecewise_construct, std::forward_as_tuple(_key),
+            std::forward_as_tuple(std::forward<Args>(_args)...)) });
+        auto* _entry = _shard.entries.back().get();
+        place(_table, _hash, _entry, std::memory_order_release);
+        ++_shard.size;
+        return { _entry, true };
+    }
+
+    std::pair<const_iterator, bool> insert(const value_type& _value)
+    {
+        return emplace(_value.first, _value.second);
+    }
+
+    TIMEMORY_NODISCARD size_type size() const
+    {
+        size_type _n = 0;
+        for(auto& itr : m_shards)
+        {
+            std::lock_guard<std::mutex> _lk{ itr.mutex };
+            _n += itr.size;
+        }
+        return _n;
+    }
+
+    TIMEMORY_NODISCARD bool empty() const { return size() == 0; }
+
+    /// invokes the function w/ each entry. Each shard is locked while it is traversed
+    /// so this is safe w.r.t. concurrent insertions but may or may not see them
+    template <typename FuncT>
+    void for_each(FuncT&& _func) const
+    {
+        for(auto& itr : m_shards)
+        {
+            std::lock_guard<std::mutex> _lk{ itr.mutex };
+            for(const auto& eitr : itr.entries)
+                _func(*eitr);
+        }
+    }
+
+    /// not safe w.r.t. concurrent lookups
+    void clear()
+    {
+        for(auto& itr : m_shards)
+        {
+            std::lock_guard<std::mutex> _lk{ itr.mutex };
+            itr.table.store(nullptr, std::memory_order_release);
+            itr.size = 0;
+            itr.tables.clear();
+            itr.entries.clear();
+        }
+    }
+
+private:
+    /// keys are often hashes already so they are mixed to decorrelate the shard index
+    /// (high bits) from the slot index (low bits)
+    static uint64_t get_hash(const KeyT& _key)
+    {
+        uint64_t _v = static_cast<uint64_t>(std::hash<KeyT>{}(_key));
+        _v ^= _v >> 33;
+        _v *= 0xff51afd7ed558ccdULL;
+        _v ^= _v >> 33;
+        _v *= 0xc4ceb9fe1a85ec53ULL;
+        _v ^= _v >> 33;
+        return _v;
+    }
+
+    static constexpr size_t shard_index(uint64_t _hash)
+    {
+        return static_cast<size_t>(_hash >> 48) & (NumShards - 1);
+    }
+
+    shard_type&       get_shard(uint64_t _hash) { return m_shards[shard_index(_hash)]; }
+    const shard_type& get_shard(uint64_t _hash) const
+    {
+        return m_shards[shard_index(_hash)];
+    }
+
+    static value_type* probe(const table_type* _table, uint64_t _hash, const KeyT& _key)
+    {
+        for(size_t i = _hash & _table->mask;; i = (i + 1) & _table->mask)
+        {
+            auto* _entry = _table->slots[i].load(std::memory_order_acquire);
+            if(!_entry)
+                return nullptr;
+            if(_entry->first == _key)
+                return _entry;
+        }
+    }
+
+    static void place(table_type* _table, uint64_t _hash, value_type* _entry,
+                      std::memory_order _order)
+    {
+        for(size_t i = _hash & _table->mask;; i = (i + 1) & _table->mask)
+        {
+            if(_table->slots[i].load(std::memory_order_relaxed) == nullptr)
+            {
+                _table->slots[i].store(_entry, _order);
+                return;
+            }
+        }
+    }
+
+    /// must be called w/ the shard lock held. The new table is fully populated before
+    /// it is published and the old table is retained for concurrent readers
+    table_type* grow(shard_type& _shard)
+    {
+        auto*  _prev     = _shard.table.load(std::memory_order_relaxed);
+        size_t _capacity = (_prev) ? (2 * _prev->capacity()) : 16;
+        auto   _table    = std::unique_ptr<table_type>{ new table_type(_capacity) };
+        for(const auto& itr : _shard.entries)
+            place(_table.get(), get_hash(itr->first), itr.get(),
+                  std::memory_order_relaxed);
+        _shard.tables.emplace_back(std::move(_table));
+        auto* _next = _shard.tables.back().get();
+        _shard.table.store(_next, std::memory_order_release);
+        return _next;
+    }
+
+private:
+    std::array<shard_type, NumShards> m_shards{};
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+}  // namespace tim
@@ -47,8 +47,8 @@ namespace tim
 TIMEMORY_HASH_LINKAGE(graph_hash_map_ptr_t&)
 get_hash_ids()
 {
-    static thread_local auto _inst =
-        get_shared_ptr_pair_instance<graph_hash_map_t, TIMEMORY_API>();
+    static auto              _master = std::make_shared<graph_hash_map_t>();
+    static thread_local auto _inst   = _master;
     return _inst;
 }
 //
@@ -57,8 +57,8 @@ get_hash_ids()
 TIMEMORY_HASH_LINKAGE(graph_hash_alias_ptr_t&)
 get_hash_aliases()
 {
-    static thread_local auto _inst =
-        get_shared_ptr_pair_instance<graph_hash_alias_t, TIMEMORY_API>();
+    static auto              _master = std::make_shared<graph_hash_alias_t>();
+    static thread_local auto _inst   = _master;
     return _inst;
 }
 //
@@ -83,7 +83,7 @@ add_hash_id(const graph_hash_map_ptr_t&   _hash_map,
     if(_hash_alias->find(_alias_hash_id) == _hash_alias->end() &&
        _hash_map->find(_hash_id) != _hash_map->end())
     {
-        (*_hash_alias)[_alias_hash_id] = _hash_id;
+        _hash_alias->emplace(_alias_hash_id, _hash_id);
     }
 }
 //
@@ -123,13 +123,15 @@ get_hash_identifier(const graph_hash_map_ptr_t&   _hash_map,
 #    if defined(DEBUG)
         ss << "\nHash map:\n";
         auto _w = 30;
-        for(const auto& itr : *_hash_map)
+        _hash_map->for_each([&ss, _w](const auto& itr) {
             ss << "    " << std::setw(_w) << itr.first << " : " << (itr.second) << "\n";
+        });
         if(_hash_alias->size() > 0)
         {
             ss << "Alias hash map:\n";
-            for(const auto& itr : *_hash_alias)
+            _hash_alias->for_each([&ss, _w](const auto& itr) {
                 ss << "    " << std::setw(_w) << itr.first << " : " << itr.second << "\n";
+            });
         }
 #    endif
         fprintf(stderr, "%s\n", ss.str().c_str());
@@ -41,3 +41,11 @@
 #else
 #    define TIMEMORY_HASH_LINKAGE(...) inline __VA_ARGS__
 #endif
+//
+/// \macro TIMEMORY_HASH_LITERAL
+/// \brief computes the hash of a string literal at compile-time, registers the string
+/// the first time it is evaluated, and returns the hash
+#if !defined(TIMEMORY_HASH_LITERAL)
+#    define TIMEMORY_HASH_LITERAL(LABEL)                                                 \
+        ::tim::add_hash_id<::tim::get_hash_id(LABEL)>(LABEL)
+#endif
@@ -25,6 +25,7 @@
 #pragma once
 
 #include "timemory/api.hpp"
+#include "timemory/hash/concurrent_map.hpp"
 #include "timemory/hash/macros.hpp"
 #include "timemory/macros/attributes.hpp"
 #include "timemory/macros/language.hpp"
@@ -72,8 +73,8 @@ get_shared_ptr_pair_master_instance();
 using hash_type = std::hash<string_view_t>;
 using hash_value_type =
     std::decay_t<decltype(hash_type{}(std::declval<string_view_t>()))>;
-using graph_hash_map_t          = std::unordered_map<hash_value_type, std::string>;
-using graph_hash_alias_t        = std::unordered_map<hash_value_type, hash_value_type>;
+using graph_hash_map_t          = concurrent_hash_map<hash_value_type, std::string>;
+using graph_hash_alias_t        = concurrent_hash_map<hash_value_type, hash_value_type>;
 using graph_hash_map_ptr_t      = std::shared_ptr<graph_hash_map_t>;
 using graph_hash_map_ptr_pair_t = std::pair<graph_hash_map_ptr_t, graph_hash_map_ptr_t>;
 using graph_hash_alias_ptr_t    = std::shared_ptr<graph_hash_alias_t>;
@@ -84,11 +85,17 @@ using graph_hash_alias_ptr_t    = std::shared_ptr<graph_hash_alias_t>;
 //
 //--------------------------------------------------------------------------------------//
 //
+/// \fn graph_hash_map_ptr_t& get_hash_ids()
+/// \brief the hash to string map. A single instance is shared by all threads.
+///
 graph_hash_map_ptr_t&
 get_hash_ids() TIMEMORY_HOT;
 //
 //--------------------------------------------------------------------------------------//
 //
+/// \fn graph_hash_alias_ptr_t& get_hash_aliases()
+/// \brief the hash to hash map. A single instance is shared by all threads.
+///
 graph_hash_alias_ptr_t&
 get_hash_aliases() TIMEMORY_HOT;
 //
@@ -98,15 +105,67 @@ get_hash_aliases() TIMEMORY_HOT;
 //
 //--------------------------------------------------------------------------------------//
 //
+/// \fn hash_value_type fnv1a_hash(const char*, size_t)
+/// \brief FNV-1a hash of a character sequence. This is the hash used for all the string
+/// identifiers and it is constexpr so that the hash of a string literal can be computed
+/// at compile-time (see \ref TIMEMORY_HASH_LITERAL).
+///
+constexpr hash_value_type fnv1a_offset =
+    (sizeof(hash_value_type) >= 8) ? static_cast<hash_value_type>(14695981039346656037ULL)
+                                   : static_cast<hash_value_type>(2166136261UL);
+constexpr hash_value_type fnv1a_prime =
+    (sizeof(hash_value_type) >= 8) ? static_cast<hash_value_type>(1099511628211ULL)
+                                   : static_cast<hash_value_type>(16777619UL);
+//
+constexpr hash_value_type
+fnv1a_hash(const char* _str, size_t _n)
+{
+    hash_value_type _v = fnv1a_offset;
+    for(size_t i = 0; i < _n; ++i)
+    {
+        _v ^= static_cast<hash_value_type>(static_cast<unsigned char>(_str[i]));
+        _v *= fnv1a_prime;
+    }
+    return _v;
+}
+//
+constexpr hash_value_type
+fnv1a_hash(const char* _str)
+{
+    hash_value_type _v = fnv1a_offset;
+    for(; _str && *_str != '\0'; ++_str)
+    {
+        _v ^= static_cast<hash_value_type>(static_cast<unsigned char>(*_str));
+        _v *= fnv1a_prime;
+    }
+    return _v;
+}
+//
+inline hash_value_type
+fnv1a_hash(const std::string& _str)
+{
+    return fnv1a_hash(_str.c_str(), _str.length());
+}
+//
+#if TIMEMORY_STRING_VIEW > 0
+constexpr hash_value_type
+fnv1a_hash(std::string_view _str)
+{
+    return fnv1a_hash(_str.data(), _str.length());
+}
+#endif
+//
+//--------------------------------------------------------------------------------------//
+//
 template <typename Tp>
-TIMEMORY_INLINE hash_value_type
-                get_hash_id(Tp&& _prefix) TIMEMORY_HOT;
+TIMEMORY_INLINE constexpr hash_value_type
+                          get_hash_id(Tp&& _prefix) TIMEMORY_HOT;
 //
 template <typename Tp>
-hash_value_type
+constexpr hash_value_type
 get_hash_id(Tp&& _prefix)
 {
-    return std::hash<string_view_t>{}(std::forward<Tp>(_prefix));
+    return fnv1a_hash(std::forward<Tp>(_prefix));
 }
 //
 //--------------------------------------------------------------------------------------//
@@ -129,9 +188,7 @@ add_hash_id(graph_hash_map_ptr_t& _hash_map, const string_view_t& _prefix)
 {
     hash_value_type _hash_id = get_hash_id(_prefix);
     if(_hash_map && _hash_map->find(_hash_id) == _hash_map->end())
-    {
-        (*_hash_map)[_hash_id] = std::string{ _prefix };
-    }
+        _hash_map->emplace(_hash_id, _prefix);
     return _hash_id;
 }
 //
@@ -152,6 +209,23 @@ add_hash_id(const string_view_t& _prefix)
 //
 //--------------------------------------------------------------------------------------//
 //
+/// \fn hash_value_type add_hash_id<HashV>(const char*)
+/// \brief add a string whose hash was computed at compile-time to the default hash-map
+/// and return the hash. The string is only registered the first time this is called so
+/// subsequent calls do not hash, construct a string, or perform a lookup. See \ref
+/// TIMEMORY_HASH_LITERAL.
+///
+template <hash_value_type HashV>
+hash_value_type
+add_hash_id(const char* _label)
+{
+    static bool _once = (get_hash_ids()->emplace(HashV, _label), true);
+    (void) _once;
+    return HashV;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
 void
 add_hash_id(const graph_hash_map_ptr_t&   _hash_map,
             const graph_hash_alias_ptr_t& _hash_alias, hash_value_type _hash_id,
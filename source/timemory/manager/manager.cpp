@@ -57,6 +57,7 @@
 
 #    include <algorithm>
 #    include <atomic>
+#    include <chrono>
 #    include <fstream>
 #    include <iosfwd>
 #    include <memory>
@@ -140,6 +141,8 @@ manager::manager()
 TIMEMORY_MANAGER_LINKAGE_API
 manager::~manager()
 {
+    stop_snapshots();
+
     auto _remain = --f_manager_instance_count();
     bool _last   = (get_shared_ptr_pair<this_type, TIMEMORY_API>().second == nullptr ||
                   _remain == 0 || m_instance_count == 0);
@@ -227,6 +230,9 @@ manager::cleanup()
 TIMEMORY_MANAGER_LINKAGE(void)
 manager::finalize()
 {
+    // snapshots must not run while the storage is merged and printed
+    stop_snapshots();
+
     m_is_finalizing = true;
     m_rank          = std::max<int32_t>(m_rank, dmp::rank());
     if(f_debug())
@@ -465,8 +471,7 @@ manager::write_metadata(const std::string& _output_dir, const char* context)
     std::map<std::string, std::set<size_t>> _hashes{};
     if(m_hash_ids && m_hash_aliases)
     {
-        for(const auto& itr : (*m_hash_aliases))
-        {
+        m_hash_aliases->for_each([&](const auto& itr) {
             auto hitr = m_hash_ids->find(itr.second);
             if(hitr != m_hash_ids->end())
             {
@@ -475,9 +480,10 @@ manager::write_metadata(const std::string& _output_dir, const char* context)
                 _hashes[operation::decode<TIMEMORY_API>{}(hitr->second)].insert(
                     hitr->first);
             }
-        }
-        for(const auto& itr : (*m_hash_ids))
+        });
+        m_hash_ids->for_each([&](const auto& itr) {
             _hashes[operation::decode<TIMEMORY_API>{}(itr.second)].insert(itr.first);
+        });
     }
     if(_hashes.empty())
         return;
@@ -741,6 +747,92 @@ manager::synchronize()
 //
 //----------------------------------------------------------------------------------//
 //
+TIMEMORY_MANAGER_LINKAGE(void)
+manager::add_snapshot(const std::string& _key, snapshot_func_t _func)
+{
+    {
+        std::unique_lock<std::mutex> _lk{ m_snapshot_mutex };
+        m_snapshots[_key] = std::move(_func);
+    }
+
+    auto _interval = (m_settings) ? m_settings->get_snapshot_interval() : 0.0;
+    if(_interval > 0.0)
+        start_snapshots(_interval);
+}
+//
+//----------------------------------------------------------------------------------//
+//
+TIMEMORY_MANAGER_LINKAGE(void)
+manager::remove_snapshot(const std::string& _key)
+{
+    std::unique_lock<std::mutex> _lk{ m_snapshot_mutex };
+    m_snapshots.erase(_key);
+}
+//
+//----------------------------------------------------------------------------------//
+//
+TIMEMORY_MANAGER_LINKAGE(int64_t)
+manager::snapshot()
+{
+    std::unique_lock<std::mutex> _lk{ m_snapshot_mutex };
+    auto                         _idx = m_snapshot_count++;
+
+    if(f_debug())
+        PRINT_HERE("writing snapshot %i [size: %i]", (int) _idx, (int) m_snapshots.size());
+
+    for(auto& itr : m_snapshots)
+        itr.second(_idx);
+    return _idx;
+}
+//
+//----------------------------------------------------------------------------------//
+//
+TIMEMORY_MANAGER_LINKAGE(void)
+manager::start_snapshots(double _interval)
+{
+    std::unique_lock<std::mutex> _lk{ m_snapshot_mutex };
+    if(m_snapshot_thread || _interval <= 0.0)
+        return;
+
+    m_snapshot_active = true;
+    auto _period      = std::chrono::duration<double>{ _interval };
+    auto _func        = [this, _period]() {
+        std::unique_lock<std::mutex> _wait_lk{ m_snapshot_mutex };
+        while(m_snapshot_active)
+        {
+            if(m_snapshot_cv.wait_for(_wait_lk, _period,
+                                      [this]() { return !m_snapshot_active; }))
+                break;
+            _wait_lk.unlock();
+            snapshot();
+            _wait_lk.lock();
+        }
+    };
+    m_snapshot_thread = std::make_unique<std::thread>(_func);
+}
+//
+//----------------------------------------------------------------------------------//
+//
+TIMEMORY_MANAGER_LINKAGE(void)
+manager::stop_snapshots()
+{
+    {
+        std::unique_lock<std::mutex> _lk{ m_snapshot_mutex };
+        if(!m_snapshot_thread)
+            return;
+        m_snapshot_active = false;
+    }
+    m_snapshot_cv.notify_all();
+
+    if(m_snapshot_thread->get_id() == std::this_thread::get_id())
+        m_snapshot_thread->detach();
+    else if(m_snapshot_thread->joinable())
+        m_snapshot_thread->join();
+    m_snapshot_thread.reset();
+}
+//
+//----------------------------------------------------------------------------------//
+//
 /*TIMEMORY_MANAGER_LINKAGE(manager::comm_group_t)
 manager::get_communicator_group()
 {
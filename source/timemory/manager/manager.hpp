@@ -42,6 +42,7 @@
 #include "timemory/tpls/cereal/cereal.hpp"
 
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <deque>
 #include <functional>
@@ -82,6 +83,8 @@ public:
     using finalizer_pair_t   = std::pair<std::string, finalizer_func_t>;
     using finalizer_list_t   = std::deque<finalizer_pair_t>;
     using synchronize_list_t = uomap_t<string_t, uomap_t<int64_t, std::function<void()>>>;
+    using snapshot_func_t    = std::function<void(int64_t)>;
+    using snapshot_list_t    = std::map<string_t, snapshot_func_t>;
     using finalizer_void_t   = std::multimap<void*, finalizer_func_t>;
     using settings_ptr_t     = std::shared_ptr<settings>;
     using filemap_t          = std::map<string_t, std::map<string_t, std::set<string_t>>>;
@@ -156,6 +159,22 @@ public:
     /// Synchronizes thread-data for storage
     void synchronize();
 
+    /// Add function for writing intermediate output of the data for a component. The
+    /// argument is the index of the snapshot. If TIMEMORY_SNAPSHOT_INTERVAL is greater
+    /// than zero, this starts the background thread for periodic snapshots
+    void add_snapshot(const std::string&, snapshot_func_t);
+    /// Remove function for writing intermediate output. Blocks while a snapshot is
+    /// in progress
+    void remove_snapshot(const std::string&);
+    /// Write intermediate output for all the components with storage without stopping
+    /// any components or finalizing the storage. Returns the index of the snapshot
+    int64_t snapshot();
+    /// Start a background thread which calls \ref snapshot every \param _interval
+    /// seconds
+    void start_snapshots(double _interval);
+    /// Stop the background thread started by \ref start_snapshots
+    void stop_snapshots();
+
 public:
     /// Get a shared pointer to the instance for the current thread
     static pointer_t instance() TIMEMORY_VISIBILITY("default");
@@ -332,6 +351,14 @@ private:
     filemap_t              m_output_files       = {};
     settings_ptr_t         m_settings           = settings::shared_instance();
 
+    /// periodic snapshots
+    bool                         m_snapshot_active = false;
+    int64_t                      m_snapshot_count  = 0;
+    snapshot_list_t              m_snapshots       = {};
+    std::mutex                   m_snapshot_mutex;
+    std::condition_variable      m_snapshot_cv;
+    std::unique_ptr<std::thread> m_snapshot_thread = {};
+
 private:
     struct persistent_data
     {
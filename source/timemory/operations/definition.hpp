@@ -52,6 +52,7 @@
 #include "timemory/operations/types/finalize/merge.hpp"
 #include "timemory/operations/types/finalize/mpi_get.hpp"
 #include "timemory/operations/types/finalize/print.hpp"
+#include "timemory/operations/types/finalize/snapshot.hpp"
 #include "timemory/operations/types/finalize/upc_get.hpp"
 #include "timemory/operations/types/fini.hpp"
 #include "timemory/operations/types/fini_storage.hpp"
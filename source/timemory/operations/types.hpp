@@ -698,6 +698,11 @@ struct merge<Type, true>
 
     TIMEMORY_COLD merge(storage_type& lhs, storage_type& rhs);
     TIMEMORY_COLD merge(result_type& lhs, result_type& rhs);
+    TIMEMORY_COLD merge(storage_type& lhs, std::vector<storage_type*> rhs,
+                        size_t _nthreads);
+
+    // merges the call-graph of one worker-thread into another worker-thread
+    TIMEMORY_COLD static void combine(storage_type& lhs, storage_type& rhs);
 
     // unary
     template <typename Tp>
@@ -747,6 +752,11 @@ struct ctest_notes;
 //
 //--------------------------------------------------------------------------------------//
 //
+template <typename Type, bool has_data>
+struct snapshot;
+//
+//--------------------------------------------------------------------------------------//
+//
 namespace base
 {
 //
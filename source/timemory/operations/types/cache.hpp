@@ -124,5 +124,85 @@ struct construct_cache<type_list<Tp...>> : construct_cache<Tp...>
 template <typename... Tp>
 using construct_cache_t = typename construct_cache<Tp...>::type;
 //
+//--------------------------------------------------------------------------------------//
+//
+/// \struct tim::operation::shared_cache
+/// \brief Holds one instance of each cache type which is used by more than one component
+/// of a bundle. Since it derives from the caches, it binds to the
+/// `start(const cache_type&)` and `stop(const cache_type&)` member functions of the
+/// components and the data source (e.g. getrusage) is read once instead of once per
+/// component.
+///
+template <typename... Tp>
+struct shared_cache : Tp...
+{
+    static constexpr bool value = (sizeof...(Tp) > 0);
+};
+//
+namespace internal
+{
+//
+/// number of types in Tp... with a cache type of CacheT
+template <typename CacheT, typename... Tp>
+struct cache_users : std::integral_constant<size_t, 0>
+{};
+//
+template <typename CacheT, typename Tp, typename... Tail>
+struct cache_users<CacheT, Tp, Tail...>
+: std::integral_constant<size_t,
+                         std::is_same<typename trait::cache<Tp>::type, CacheT>::value +
+                             cache_users<CacheT, Tail...>::value>
+{};
+//
+template <typename DataT, typename ResultT, typename... Tp>
+struct shared_cache_types
+{
+    using type = ResultT;
+};
+//
+template <typename... DataT, typename... ResultT, typename Tp, typename... Tail>
+struct shared_cache_types<std::tuple<DataT...>, shared_cache<ResultT...>, Tp, Tail...>
+{
+    using cache_type = typename trait::cache<Tp>::type;
+
+    static constexpr bool value = !concepts::is_null_type<cache_type>::value &&
+                                  !is_one_of<cache_type, std::tuple<ResultT...>>::value &&
+                                  (cache_users<cache_type, DataT...>::value > 1);
+
+    using type = typename shared_cache_types<
+        std::tuple<DataT...>,
+        conditional_t<value, shared_cache<ResultT..., cache_type>,
+                      shared_cache<ResultT...>>,
+        Tail...>::type;
+};
+}  // namespace internal
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \struct tim::operation::construct_shared_cache
+/// \brief Provides the \ref tim::operation::shared_cache of the cache types which are
+/// used by at least two of the (non-pointer) component types
+///
+template <typename... Tp>
+struct construct_shared_cache
+{
+    using data_type = std::tuple<std::remove_pointer_t<decay_t<Tp>>...>;
+    using type      = typename internal::shared_cache_types<
+        data_type, shared_cache<>, std::remove_pointer_t<decay_t<Tp>>...>::type;
+
+    auto operator()() const { return type{}; }
+};
+//
+template <typename... Tp>
+struct construct_shared_cache<std::tuple<Tp...>> : construct_shared_cache<Tp...>
+{};
+//
+template <typename... Tp>
+struct construct_shared_cache<type_list<Tp...>> : construct_shared_cache<Tp...>
+{};
+//
+template <typename... Tp>
+using construct_shared_cache_t = typename construct_shared_cache<Tp...>::type;
+//
 }  // namespace operation
 }  // namespace tim
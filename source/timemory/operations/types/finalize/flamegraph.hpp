@@ -23,8 +23,8 @@
 // SOFTWARE.
 
 /**
- * \file timemory/operations/types/finalize_get.hpp
- * \brief Definition for various functions for finalize_get in operations
+ * \file timemory/operations/types/finalize/flamegraph.hpp
+ * \brief Definition for the trace-event (flamegraph) output in operations
  */
 
 #pragma once
@@ -35,6 +35,10 @@
 #include "timemory/operations/types.hpp"
 #include "timemory/settings/declaration.hpp"
 #include "timemory/units.hpp"
+#include "timemory/utility/trace_writer.hpp"
+
+#include <map>
+#include <string>
 
 namespace tim
 {
@@ -96,128 +100,80 @@ flamegraph<Type>::flamegraph(storage_type* _data, std::string _label,  // NOLINT
     if(results.empty())
         return;
 
-    using Archive = cereal::MinimalJSONOutputArchive;
-    // using Archive     = cereal::PrettyJSONOutputArchive;
-    using policy_type = policy::output_archive<Archive, TIMEMORY_API>;
-
     auto outfname =
         settings::compose_output_filename(_label + std::string(".flamegraph"), ".json");
 
-    if(outfname.length() > 0)
+    if(outfname.empty())
+        return;
+
+    // the events are streamed to the file instead of building the JSON in memory
+    trace_writer _writer{ outfname };
+    if(!_writer.is_open())
+        return;
+
+    manager::instance()->add_json_output(_label, outfname);
+    printf("[%s]|%i> Outputting '%s'...\n", _label.c_str(), node_rank,
+           outfname.c_str());
+
+    using value_type   = decay_t<decltype(std::declval<const Type>().get())>;
+    using offset_map_t = std::map<int64_t, value_type>;
+    using useoff_map_t = std::map<int64_t, bool>;
+    auto         conv  = units::usec;
+    offset_map_t total_offset;
+    offset_map_t last_offset;
+    offset_map_t last_value;
+    useoff_map_t use_last;
+    int64_t      max_depth = 1;
+    std::string  _buffer{};
+    _buffer.reserve(trace_writer::buffer_size);
+
+    for(auto& itr : results)
+    {
+        max_depth             = std::max<int64_t>(max_depth, itr.depth() + 1);
+        use_last[itr.depth()] = false;
+    }
+
+    for(auto& itr : results)
     {
-        std::ofstream ofs(outfname.c_str());
-        if(ofs)
+        auto _prefix = itr.prefix();
+        auto value   = itr.data().get() * conv;
+
+        auto litr = last_offset.find(itr.depth());
+        if(litr != last_offset.end())
         {
-            manager::instance()->add_json_output(_label, outfname);
-            printf("[%s]|%i> Outputting '%s'...\n", _label.c_str(), node_rank,
-                   outfname.c_str());
-
-            // ensure write final block during destruction before the file is closed
-            auto oa = policy_type::get(ofs);
-
-            oa->setNextName("traceEvents");
-            oa->startNode();
-            oa->makeArray();
-
-            using value_type   = decay_t<decltype(std::declval<const Type>().get())>;
-            using offset_map_t = std::map<int64_t, value_type>;
-            using useoff_map_t = std::map<int64_t, bool>;
-            auto         conv  = units::usec;
-            offset_map_t total_offset;
-            offset_map_t last_offset;
-            offset_map_t last_value;
-            useoff_map_t use_last;
-            int64_t      max_depth = 1;
-
-            for(auto& itr : results)
-            {
-                max_depth             = std::max<int64_t>(max_depth, itr.depth() + 1);
-                use_last[itr.depth()] = false;
-            }
+            total_offset[itr.depth()] += litr->second;
 
-            for(auto& itr : results)
+            for(int64_t i = itr.depth() + 1; i < max_depth; ++i)
             {
-                auto _prefix = itr.prefix();
-                auto value   = itr.data().get() * conv;
-
-                auto litr = last_offset.find(itr.depth());
-                if(litr != last_offset.end())
-                {
-                    // for(int64_t i = 0; i < max_depth; ++i)
-                    //    use_last[i] = false;
-
-                    total_offset[itr.depth()] += litr->second;
-
-                    for(int64_t i = itr.depth() + 1; i < max_depth; ++i)
-                    {
-                        // use_last[i] = true;
-                        total_offset[i] = total_offset[itr.depth()];
-                        last_value[i]   = litr->second;
-                        auto ditr       = last_offset.find(i);
-                        if(ditr != last_offset.end())
-                            last_offset.erase(ditr);
-                    }
-                    last_offset.erase(litr);
-                }
-
-                value_type offset = total_offset[itr.depth()];
-                if(use_last[itr.depth()])
-                    offset += last_value[itr.depth()] - value;
-
-                oa->startNode();
-
-                // oa->setNextName("args");
-                // oa->startNode();
-                // (*oa)(cereal::make_nvp("detail", _prefix));
-                // (*oa)(cereal::make_nvp("count", itr.data().get_laps()));
-                // (*oa)(cereal::make_nvp("depth", itr.depth()));
-                // (*oa)(cereal::make_nvp("units", itr.data().get_display_unit()));
-                // oa->finishNode();
-
-                string_t _ph = "X";
-                if(_prefix.find(">>>") != std::string::npos)
-                    _prefix = _prefix.substr(_prefix.find_first_of(">>>") + 3);
-                if(_prefix.find("|_") != std::string::npos)
-                    _prefix = _prefix.substr(_prefix.find_first_of("|_") + 2);
-
-                (*oa)(cereal::make_nvp("dur", value));
-                (*oa)(cereal::make_nvp("name", _prefix));
-                (*oa)(cereal::make_nvp("ph", _ph));
-                (*oa)(cereal::make_nvp("pid", itr.pid()));
-                (*oa)(cereal::make_nvp("tid", itr.tid()));
-                (*oa)(cereal::make_nvp("ts", offset));
-
-                oa->finishNode();
-
-                last_offset[itr.depth()] = value;
-                last_value[itr.depth()]  = value;
-                // total_offset[itr.depth()] += value;
+                total_offset[i] = total_offset[itr.depth()];
+                last_value[i]   = litr->second;
+                auto ditr       = last_offset.find(i);
+                if(ditr != last_offset.end())
+                    last_offset.erase(ditr);
             }
-
-            /*
-            oa->startNode();
-            oa->setNextName("args");
-            oa->startNode();
-            (*oa)(cereal::make_nvp("name", _label));
-            oa->finishNode();
-            string_t _ph = "M";
-            string_t _cat = "";
-            string_t _name = "metric";
-            (*oa)(cereal::make_nvp("cat", _cat));
-            (*oa)(cereal::make_nvp("name", _name));
-            (*oa)(cereal::make_nvp("ph", _ph));
-            (*oa)(cereal::make_nvp("pid", process::get_id()));
-            (*oa)(cereal::make_nvp("tid", 0));
-            (*oa)(cereal::make_nvp("ts", 0));
-            oa->finishNode();
-            */
-
-            oa->finishNode();
+            last_offset.erase(litr);
         }
-        if(ofs)
-            ofs << std::endl;
-        ofs.close();
+
+        value_type offset = total_offset[itr.depth()];
+        if(use_last[itr.depth()])
+            offset += last_value[itr.depth()] - value;
+
+        if(_prefix.find(">>>") != std::string::npos)
+            _prefix = _prefix.substr(_prefix.find_first_of(">>>") + 3);
+        if(_prefix.find("|_") != std::string::npos)
+            _prefix = _prefix.substr(_prefix.find_first_of("|_") + 2);
+
+        trace_writer::complete(_buffer, _prefix, itr.pid(), itr.tid(),
+                               static_cast<double>(offset), static_cast<double>(value));
+        if(_buffer.size() >= trace_writer::buffer_size)
+            _writer.write(_buffer);
+
+        last_offset[itr.depth()] = value;
+        last_value[itr.depth()]  = value;
     }
+
+    _writer.write(_buffer);
+    _writer.close();
 }
 //
 //--------------------------------------------------------------------------------------//
@@ -36,7 +36,10 @@
 #include "timemory/storage/basic_tree.hpp"
 #include "timemory/storage/graph.hpp"
 
+#include <algorithm>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 namespace tim
 {
@@ -71,21 +74,6 @@ merge<Type, true>::merge(storage_type& lhs, storage_type& rhs)
     if(!l.owns_lock())
         l.lock();
 
-    auto _copy_hash_ids = [&lhs, &rhs]() {
-        auto _hash_ids     = *rhs.get_hash_ids();
-        auto _hash_aliases = *rhs.get_hash_aliases();
-        for(const auto& itr : _hash_ids)
-        {
-            if(lhs.m_hash_ids->find(itr.first) == lhs.m_hash_ids->end())
-                (*lhs.m_hash_ids)[itr.first] = itr.second;
-        }
-        for(const auto& itr : _hash_aliases)
-        {
-            if(lhs.m_hash_aliases->find(itr.first) == lhs.m_hash_aliases->end())
-                (*lhs.m_hash_aliases)[itr.first] = itr.second;
-        }
-    };
-
     // if self is not initialized but itr is, copy data
     if(rhs.is_initialized() && !lhs.is_initialized())
     {
@@ -94,12 +82,9 @@ merge<Type, true>::merge(storage_type& lhs, storage_type& rhs)
         lhs.graph().insert_subgraph_after(lhs._data().head(), rhs.data().head());
         lhs.m_initialized = rhs.m_initialized;
         lhs.m_finalized   = rhs.m_finalized;
-        _copy_hash_ids();
         return;
     }
 
-    _copy_hash_ids();
-
     if(rhs.empty() || !rhs.data().has_head())
         return;
 
@@ -182,6 +167,117 @@ merge<Type, true>::merge(storage_type& lhs, storage_type& rhs)
 //--------------------------------------------------------------------------------------//
 //
 template <typename Type>
+merge<Type, true>::merge(storage_type& lhs, std::vector<storage_type*> rhs,
+                         size_t _nthreads)
+{
+    auto _is_valid = [&lhs](storage_type* itr) {
+        return (itr && itr != &lhs && itr->is_initialized());
+    };
+    rhs.erase(std::remove_if(rhs.begin(), rhs.end(),
+                             [&_is_valid](storage_type* itr) { return !_is_valid(itr); }),
+              rhs.end());
+
+    for(auto& itr : rhs)
+        itr->stack_clear();
+
+    rhs.erase(std::remove_if(rhs.begin(), rhs.end(),
+                             [](storage_type* itr) {
+                                 return (itr->empty() || !itr->data().has_head());
+                             }),
+              rhs.end());
+
+    if(rhs.empty())
+        return;
+
+    if(!lhs.is_initialized())
+    {
+        // the serial merge handles (and warns about) an uninitialized master
+        for(auto& itr : rhs)
+            merge<Type, true>{ lhs, *itr };
+        return;
+    }
+
+    _nthreads = std::max<size_t>(_nthreads, 1);
+
+    // the worker call-graphs must not be read by a snapshot while being combined
+    auto_lock_t _lk(singleton_t::get_mutex());
+
+    // log2(N) rounds where rhs[i] absorbs rhs[i + stride] so that the worker-thread
+    // call-graphs are combined in the same order as the serial merge
+    for(size_t _stride = 1; _stride < rhs.size(); _stride *= 2)
+    {
+        std::vector<std::pair<storage_type*, storage_type*>> _pairs{};
+        for(size_t i = 0; i + _stride < rhs.size(); i += 2 * _stride)
+            _pairs.emplace_back(rhs.at(i), rhs.at(i + _stride));
+
+        auto _n    = std::min<size_t>(_nthreads, _pairs.size());
+        auto _func = [&_pairs, _n](size_t _offset) {
+            for(size_t i = _offset; i < _pairs.size(); i += _n)
+                combine(*_pairs.at(i).first, *_pairs.at(i).second);
+        };
+
+        std::vector<std::thread> _threads{};
+        _threads.reserve(_n);
+        for(size_t i = 1; i < _n; ++i)
+            _threads.emplace_back(_func, i);
+        _func(0);
+        for(auto& itr : _threads)
+            itr.join();
+
+        if(settings::debug() || settings::verbose() > 2)
+        {
+            PRINT_HERE("[%s]> combined %i worker call-graphs with %i threads",
+                       Type::get_label().c_str(), (int) _pairs.size(), (int) _n);
+        }
+    }
+
+    merge<Type, true>{ lhs, *rhs.front() };
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+void
+merge<Type, true>::combine(storage_type& lhs, storage_type& rhs)
+{
+    using pre_order_iterator = typename graph_t::pre_order_iterator;
+    using sibling_iterator   = typename graph_t::sibling_iterator;
+
+    if(&lhs == &rhs || !rhs.data().has_head())
+        return;
+
+    // process the bookmarks in the same order as the merge into the master so that
+    // the children are appended in the same order
+    for(auto entry : rhs.data().get_inverse_insert())
+    {
+        pre_order_iterator pitr(entry.second);
+        if(!pitr || !rhs.graph().is_valid(pitr))
+            continue;
+
+        pre_order_iterator pos = lhs.data().find_dummy(pitr);
+        if(pos)
+        {
+            sibling_iterator other = pitr;
+            for(auto sitr = other.begin(); sitr != other.end(); ++sitr)
+            {
+                pre_order_iterator pchild = sitr;
+                if(pchild->obj().get_laps() == 0)
+                    continue;
+                lhs.graph().append_child(pos, pchild);
+            }
+        }
+        else
+        {
+            lhs.data().add_dummy(pitr);
+        }
+    }
+
+    rhs.data().clear();
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
 merge<Type, true>::merge(result_type& dst, result_type& src)
 {
     using result_node = typename result_type::value_type;
@@ -302,21 +398,22 @@ merge<Type, true>::operator()(const basic_tree<Tp>& _bt)
         *itr = (*this)(*itr);
 
     // aggregate children
-    children_type _children{};
+    children_type                                _children{};
+    std::unordered_map<hash_value_type, size_t> _index{};
+    _children.reserve(_ret.get_children().size());
+    _index.reserve(_ret.get_children().size());
     for(auto& itr : _ret.get_children())
     {
-        bool found = false;
-        for(auto& citr : _children)
+        auto citr = _index.find(itr->get_hash());
+        if(citr != _index.end())
         {
-            if(*citr == *itr)
-            {
-                found = true;
-                *citr += *itr;
-            }
+            *_children.at(citr->second) += *itr;
         }
-        if(!found)
+        else
+        {
+            _index.emplace(itr->get_hash(), _children.size());
             _children.emplace_back(itr);
-        // _children.emplace_back(std::move(itr));
+        }
     }
 
     // update new children
@@ -357,58 +454,43 @@ merge<Type, true>::operator()(const std::vector<basic_tree<Tp>>& _lhs,
 {
     using basic_t      = basic_tree<Tp>;
     using basic_vec_t  = std::vector<basic_t>;
-    using basic_map_t  = std::map<size_t, basic_t>;
     using basic_bool_t = std::vector<bool>;
+    using index_map_t  = std::unordered_map<hash_value_type, std::vector<size_t>>;
+
+    // index the rhs instances by hash so that matching is linear in the number of
+    // instances instead of comparing every lhs instance with every rhs instance
+    auto _index = index_map_t{};
+    _index.reserve(_rhs.size());
+    for(size_t j = 0; j < _rhs.size(); ++j)
+        _index[_rhs.at(j).get_hash()].emplace_back(j);
 
-    auto _p  = basic_map_t{};  // map of paired instances in lhs and rhs
-    auto _ul = basic_map_t{};  // map of unpaired instances in lhs
-    auto _ur = basic_map_t{};  // map of unpaired instances in rhs
-    auto _bl = basic_bool_t(_lhs.size(), false);  // track if unpaired
-    auto _br = basic_bool_t(_rhs.size(), false);
+    auto _l  = basic_vec_t(_lhs.size());  // lhs instances (paired or unpaired)
+    auto _br = basic_bool_t(_rhs.size(), false);  // track if rhs is paired
     for(size_t i = 0; i < _lhs.size(); ++i)
     {
-        const auto& _l = _lhs.at(i);
-        // look for any matches b/t lhs and rhs
-        for(size_t j = 0; j < _rhs.size(); ++j)
+        _l.at(i) = (*this)(_lhs.at(i));
+        // add any matches b/t lhs and rhs
+        auto itr = _index.find(_l.at(i).get_hash());
+        if(itr == _index.end())
+            continue;
+        for(auto j : itr->second)
         {
-            const auto& _r = _rhs.at(j);
-            if(_l == _r)
-            {
-                _bl.at(i) = true;
-                _br.at(j) = true;
-                if(_p.find(i) == _p.end())
-                    _p[i] = (*this)(_l);
-                _p[i] += (*this)(_r);
-            }
+            _br.at(j) = true;
+            _l.at(i) += (*this)(_rhs.at(j));
         }
-        // insert any unmatched instances into unused-lhs map
-        if(!_bl.at(i))
-            _ul[i] = (*this)(_l);
-    }
-
-    for(size_t j = 0; j < _rhs.size(); ++j)
-    {
-        // insert any unmatched instances into unused-rhs map
-        const auto& _r = _rhs.at(j);
-        if(!_br.at(j))
-            _ur[j] = (*this)(_r);
     }
 
-    // create the final product
+    // create the final product: unpaired rhs instances follow the lhs instance with
+    // the same index
     auto _ret = basic_vec_t{};
     auto n    = std::max<size_t>(_lhs.size(), _rhs.size());
-    _ret.reserve(n);
+    _ret.reserve(_lhs.size() + _rhs.size());
     for(size_t i = 0; i < n; ++i)
     {
-        auto _append = [&](auto& _obj) {
-            auto itr = _obj.find(i);
-            if(itr != _obj.end())
-                _ret.emplace_back(itr->second);
-            //_ret.emplace_back(std::move(itr->second));
-        };
-        _append(_p);
-        _append(_ul);
-        _append(_ur);
+        if(i < _l.size())
+            _ret.emplace_back(std::move(_l.at(i)));
+        if(i < _rhs.size() && !_br.at(i))
+            _ret.emplace_back((*this)(_rhs.at(i)));
     }
 
     return (*this)(_ret);
@@ -492,16 +574,8 @@ merge<Type, false>::merge(storage_type& lhs, storage_type& rhs)
     if(!l.owns_lock())
         l.lock();
 
-    for(const auto& itr : *rhs.get_hash_ids())
-    {
-        if(lhs.m_hash_ids->find(itr.first) == lhs.m_hash_ids->end())
-            (*lhs.m_hash_ids)[itr.first] = itr.second;
-    }
-    for(const auto& itr : (*rhs.get_hash_aliases()))
-    {
-        if(lhs.m_hash_aliases->find(itr.first) == lhs.m_hash_aliases->end())
-            (*lhs.m_hash_aliases)[itr.first] = itr.second;
-    }
+    // the hash ids and aliases are shared by all threads so there is nothing to merge
+    consume_parameters(lhs);
 }
 //
 //--------------------------------------------------------------------------------------//
@@ -35,6 +35,10 @@
 #include "timemory/operations/types/finalize/get.hpp"
 #include "timemory/settings/declaration.hpp"
 
+#include <cstring>
+#include <string>
+#include <type_traits>
+
 namespace tim
 {
 namespace operation
@@ -60,9 +64,23 @@ struct mpi_get<Type, true>
     using metadata_t             = typename get_type::metadata;
     using basic_tree_type        = typename get_type::basic_tree_vector_type;
     using basic_tree_vector_type = std::vector<basic_tree_type>;
+    using stats_type = decay_t<decltype(std::declval<result_node>().stats())>;
+
+    /// the results can be encoded by copying the bytes of the component and the
+    /// statistics, which is valid b/t ranks running the same executable
+    static constexpr bool supports_binary = std::is_trivially_copyable<Type>::value &&
+                                            std::is_trivially_copyable<stats_type>::value;
 
     static auto& plus(Type& lhs, const Type& rhs) { return (lhs += rhs); }
 
+    /// encodes the results for sending to another rank. The encoding is binary if
+    /// requested and \ref supports_binary, otherwise it is JSON
+    static TIMEMORY_COLD std::string encode(const result_type&, bool _binary);
+
+    /// decodes the results received from another rank. \param _binary must be the
+    /// same value passed to \ref encode
+    static TIMEMORY_COLD result_type decode(const std::string&, bool _binary);
+
     explicit TIMEMORY_COLD mpi_get(storage_type& _storage)
     : m_storage(&_storage)
     {}
@@ -80,6 +98,19 @@ struct mpi_get<Type, true>
         std::vector<Type>& dst, const Type& src,
         std::function<Type&(Type& lhs, const Type& rhs)>&& adder = this_type::plus);
 
+private:
+    static std::string encode(const result_type&, std::true_type);
+    static std::string encode(const result_type&, std::false_type);
+    static result_type decode(const std::string&, std::true_type);
+    static result_type decode(const std::string&, std::false_type);
+
+    /// merges the results of the ranks in \param comm pairwise in a binomial tree.
+    /// On rank 0 of the communicator, \param _accum holds the combined results of
+    /// all the ranks upon return. \param _accum is only assigned from \param _own
+    /// when the first set of results is received so leaf ranks never copy
+    static void reduce(const result_type& _own, result_type& _accum, mpi::comm_t comm,
+                       bool _binary);
+
 private:
     storage_type* m_storage = nullptr;
 };
@@ -128,39 +159,6 @@ mpi_get<Type, true>::operator()(distrib_type& results)
     int comm_rank = mpi::rank(comm);
     int comm_size = mpi::size(comm);
 
-    //------------------------------------------------------------------------------//
-    //  Used to convert a result to a serialization
-    //
-    auto send_serialize = [&](const result_type& src) {
-        std::stringstream ss;
-        {
-            auto oa = policy::output_archive<cereal::MinimalJSONOutputArchive,
-                                             TIMEMORY_API>::get(ss);
-            (*oa)(cereal::make_nvp("data", src));
-        }
-        return ss.str();
-    };
-
-    //------------------------------------------------------------------------------//
-    //  Used to convert the serialization to a result
-    //
-    auto recv_serialize = [&](const std::string& src) {
-        result_type       ret;
-        std::stringstream ss;
-        ss << src;
-        {
-            auto ia =
-                policy::input_archive<cereal::JSONInputArchive, TIMEMORY_API>::get(ss);
-            (*ia)(cereal::make_nvp("data", ret));
-            if(settings::debug())
-            {
-                printf("[RECV: %i]> data size: %lli\n", comm_rank,
-                       (long long int) ret.size());
-            }
-        }
-        return ret;
-    };
-
     //------------------------------------------------------------------------------//
     //  Calculate the total number of measurement records
     //
@@ -174,9 +172,69 @@ mpi_get<Type, true>::operator()(distrib_type& results)
     results = distrib_type(comm_size);
 
     auto ret     = data.get();
-    auto str_ret = send_serialize(ret);
+    bool _binary = settings::mpi_binary_gather();
 
-    if(comm_rank == 0)
+    //
+    //  Merge the results pairwise in a reduction tree: first within each node and
+    //  then across the first rank of each node. No rank ever holds more than two
+    //  sets of results and rank 0 is the only rank which reports the combined data
+    //
+    if(settings::collapse_processes() && settings::node_count() <= 1 &&
+       settings::mpi_tree_reduction())
+    {
+        result_type _accum{};
+        if(comm_rank == 0)
+            std::swap(_accum, ret);
+
+        // the communicators are created collectively so every rank must request them
+        auto _node_comm = mpi::get_node_comm();
+        auto _head_comm = mpi::get_node_head_comm();
+
+        reduce(ret, _accum, _node_comm, _binary);
+        if(mpi::rank(_node_comm) == 0)
+            reduce(ret, _accum, _head_comm, _binary);
+
+        results = distrib_type{};
+        results.emplace_back((comm_rank == 0) ? std::move(_accum) : std::move(ret));
+
+        if(settings::debug() || settings::verbose() > 3)
+        {
+            PRINT_HERE("[%s][pid=%i][rank=%i]> reduced %i records from %i ranks",
+                       demangle<mpi_get<Type, true>>().c_str(), (int) process::get_id(),
+                       comm_rank, get_num_records(results), comm_size);
+        }
+        return results;
+    }
+
+    auto str_ret   = encode(ret, _binary);
+    bool _gathered = false;
+
+    //
+    //  Collect the data from all ranks with one collective operation
+    //
+    if(_binary)
+    {
+        std::vector<std::string> _strs{};
+        _gathered = mpi::gather(str_ret, _strs, 0, comm);
+        if(_gathered && comm_rank == 0)
+        {
+            for(int i = 1; i < comm_size; ++i)
+                results[i] = decode(_strs.at(i), _binary);
+            results[comm_rank] = std::move(ret);
+        }
+        else if(_gathered)
+        {
+            results = distrib_type{};
+            results.emplace_back(std::move(ret));
+        }
+    }
+
+    if(_gathered)
+    {
+        if(settings::debug())
+            printf("[GATHER: %i]> completed\n", comm_rank);
+    }
+    else if(comm_rank == 0)
     {
         //
         //  The root rank receives data from all non-root ranks and reports all data
@@ -189,7 +247,7 @@ mpi_get<Type, true>::operator()(distrib_type& results)
             mpi::recv(str, i, 0, comm);
             if(settings::debug())
                 printf("[RECV: %i]> completed %i\n", comm_rank, i);
-            results[i] = recv_serialize(str);
+            results[i] = decode(str, _binary);
         }
         results[comm_rank] = std::move(ret);
     }
@@ -341,6 +399,188 @@ mpi_get<Type, true>::operator()(distrib_type& results)
 //--------------------------------------------------------------------------------------//
 //
 template <typename Type>
+std::string
+mpi_get<Type, true>::encode(const result_type& src, bool _binary)
+{
+    if(_binary)
+        return encode(src, std::integral_constant<bool, supports_binary>{});
+    return encode(src, std::false_type{});
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+typename mpi_get<Type, true>::result_type
+mpi_get<Type, true>::decode(const std::string& src, bool _binary)
+{
+    if(_binary)
+        return decode(src, std::integral_constant<bool, supports_binary>{});
+    return decode(src, std::false_type{});
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+std::string
+mpi_get<Type, true>::encode(const result_type& src, std::true_type)
+{
+    std::string _ret{};
+    auto        _write = [&_ret](const void* _v, size_t _n) {
+        _ret.append(static_cast<const char*>(_v), _n);
+    };
+    auto _write_value = [&_write](const auto& _v) { _write(&_v, sizeof(_v)); };
+
+    _ret.reserve(sizeof(uint64_t) +
+                 src.size() * (sizeof(result_node) + sizeof(Type) + sizeof(stats_type)));
+
+    uint64_t _n = src.size();
+    _write_value(_n);
+    for(const auto& itr : src)
+    {
+        uint64_t _len = itr.prefix().length();
+        _write_value(itr.tid());
+        _write_value(itr.pid());
+        _write_value(itr.depth());
+        _write_value(itr.hash());
+        _write_value(itr.rolling_hash());
+        _write_value(_len);
+        _write(itr.prefix().data(), _len);
+        _write_value(itr.data());
+        _write_value(itr.stats());
+    }
+    return _ret;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+typename mpi_get<Type, true>::result_type
+mpi_get<Type, true>::decode(const std::string& src, std::true_type)
+{
+    size_t _offset = 0;
+    auto   _read   = [&src, &_offset](void* _v, size_t _n) {
+        if(_offset + _n > src.size())
+            return false;
+        if(_n > 0)
+            memcpy(_v, src.data() + _offset, _n);
+        _offset += _n;
+        return true;
+    };
+    auto _read_value = [&_read](auto& _v) { return _read(&_v, sizeof(_v)); };
+
+    result_type _ret{};
+    uint64_t    _n = 0;
+    if(!_read_value(_n))
+        return _ret;
+
+    _ret.resize(_n);
+    for(uint64_t i = 0; i < _n; ++i)
+    {
+        auto&    itr  = _ret.at(i);
+        uint64_t _len = 0;
+        bool     _ok  = _read_value(itr.tid()) && _read_value(itr.pid()) &&
+                   _read_value(itr.depth()) && _read_value(itr.hash()) &&
+                   _read_value(itr.rolling_hash()) && _read_value(_len) &&
+                   _len <= src.size() - _offset;
+        if(_ok)
+        {
+            itr.prefix().resize(_len);
+            _ok = _read(&itr.prefix()[0], _len) && _read_value(itr.data()) &&
+                  _read_value(itr.stats());
+        }
+        if(!_ok)
+        {
+            PRINT_HERE("[%s]> Warning! binary data truncated after %lu of %lu records",
+                       demangle<mpi_get<Type, true>>().c_str(), (unsigned long) i,
+                       (unsigned long) _n);
+            _ret.resize(i);
+            break;
+        }
+        // the iterator is only meaningful on the sending rank
+        itr.data().set_iterator(nullptr);
+        itr.data().set_is_transient(true);
+    }
+    return _ret;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+std::string
+mpi_get<Type, true>::encode(const result_type& src, std::false_type)
+{
+    std::stringstream ss;
+    {
+        auto oa =
+            policy::output_archive<cereal::MinimalJSONOutputArchive, TIMEMORY_API>::get(
+                ss);
+        (*oa)(cereal::make_nvp("data", src));
+    }
+    return ss.str();
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+typename mpi_get<Type, true>::result_type
+mpi_get<Type, true>::decode(const std::string& src, std::false_type)
+{
+    result_type       ret;
+    std::stringstream ss;
+    ss << src;
+    {
+        auto ia = policy::input_archive<cereal::JSONInputArchive, TIMEMORY_API>::get(ss);
+        (*ia)(cereal::make_nvp("data", ret));
+        if(settings::debug())
+            printf("[RECV]> data size: %lli\n", (long long int) ret.size());
+    }
+    return ret;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+void
+mpi_get<Type, true>::reduce(const result_type& _own, result_type& _accum,
+                            mpi::comm_t comm, bool _binary)
+{
+    int comm_rank = mpi::rank(comm);
+    int comm_size = mpi::size(comm);
+
+    for(int _stride = 1; _stride < comm_size; _stride *= 2)
+    {
+        if(comm_rank % (2 * _stride) != 0)
+        {
+            //
+            //  send the partially reduced results to the partner and drop out
+            //
+            auto _dst = comm_rank - _stride;
+            if(settings::debug())
+                printf("[REDUCE: %i]> sending to %i\n", comm_rank, _dst);
+            mpi::send(encode((_accum.empty()) ? _own : _accum, _binary), _dst, 0, comm);
+            _accum.clear();
+            return;
+        }
+
+        auto _src = comm_rank + _stride;
+        if(_src < comm_size)
+        {
+            std::string _str{};
+            if(settings::debug())
+                printf("[REDUCE: %i]> receiving from %i\n", comm_rank, _src);
+            mpi::recv(_str, _src, 0, comm);
+            auto _other = decode(_str, _binary);
+            _str        = std::string{};
+            if(_accum.empty())
+                _accum = _own;
+            operation::finalize::merge<Type, true>(_accum, _other);
+        }
+    }
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
 typename mpi_get<Type, true>::basic_tree_vector_type&
 mpi_get<Type, true>::operator()(basic_tree_vector_type& bt)
 {
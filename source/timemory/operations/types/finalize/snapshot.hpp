@@ -0,0 +1,315 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * \file timemory/operations/types/finalize/snapshot.hpp
+ * \brief Definition for writing intermediate output while the data is still being
+ * collected
+ */
+
+#pragma once
+
+#include "timemory/operations/declaration.hpp"
+#include "timemory/operations/macros.hpp"
+#include "timemory/operations/types.hpp"
+#include "timemory/operations/types/finalize/get.hpp"
+#include "timemory/operations/types/finalize/merge.hpp"
+#include "timemory/operations/types/finalize/print.hpp"
+#include "timemory/operations/types/math.hpp"
+#include "timemory/settings/declaration.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tim
+{
+namespace operation
+{
+namespace finalize
+{
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \struct tim::operation::finalize::snapshot
+/// \brief Collects the results of the master thread and every worker thread without
+/// stopping any components, merging the call-graphs, or finalizing the storage. The
+/// structure of each call-graph is locked while it is converted to results so the
+/// thread which owns it only stalls if it inserts a new node during that time. The
+/// results of each worker thread are combined with the results of the other worker
+/// threads at the same position but, since the call-graphs are not merged, they are
+/// reported after the results of the master thread.
+template <typename Type>
+struct snapshot<Type, true>
+{
+    static constexpr bool value = true;
+    using storage_type          = impl::storage<Type, value>;
+    using singleton_t           = typename storage_type::singleton_type;
+    using auto_lock_t           = typename storage_type::auto_lock_t;
+    using graph_data_t          = typename storage_type::graph_data_t;
+    using result_type           = typename storage_type::result_array_t;
+    using distrib_type          = typename storage_type::dmp_result_t;
+    using result_node           = typename storage_type::result_node;
+
+    /// exposes the maximum depth to the snapshot since the results are not
+    /// provided through the collective setup of the print operation
+    struct printer_type : print<Type, value>
+    {
+        using base_type = print<Type, value>;
+        using base_type::base_type;
+
+        void set_max_depth(int64_t _v) { this->max_depth = _v; }
+    };
+
+    explicit TIMEMORY_COLD snapshot(storage_type& _storage)
+    : m_storage(&_storage)
+    {}
+
+    /// get the current results
+    TIMEMORY_COLD result_type& operator()(result_type&);
+
+    /// write the current results to the output files tagged with the index of the
+    /// snapshot. When TIMEMORY_SNAPSHOT_DELTA is enabled, the data from the previous
+    /// snapshot is subtracted. Returns the names of the files written
+    TIMEMORY_COLD std::vector<std::string> operator()(int64_t _idx);
+
+    /// the results of the previous snapshot
+    static result_type& get_previous()
+    {
+        static result_type _instance{};
+        return _instance;
+    }
+
+    /// subtract the matching entries of a previous snapshot
+    static result_type& subtract(result_type& _lhs, const result_type& _rhs);
+
+private:
+    static result_type get_results(storage_type* _storage);
+
+private:
+    storage_type* m_storage = nullptr;
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+struct snapshot<Type, false>
+{
+    static constexpr bool value = false;
+    using storage_type          = impl::storage<Type, value>;
+
+    snapshot(storage_type&) {}
+
+    template <typename Tp>
+    Tp& operator()(Tp& _v)
+    {
+        return _v;
+    }
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+typename snapshot<Type, true>::result_type
+snapshot<Type, true>::get_results(storage_type* _storage)
+{
+    result_type _ret{};
+    if(!_storage || !_storage->is_initialized() || !_storage->m_graph_data_instance)
+        return _ret;
+
+    typename graph_data_t::lock_t _lk{
+        _storage->m_graph_data_instance->structure_mutex()
+    };
+    get<Type, true>{ _storage }(_ret);
+    return _ret;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+typename snapshot<Type, true>::result_type&
+snapshot<Type, true>::operator()(result_type& _ret)
+{
+    if(!m_storage)
+        return _ret;
+
+    // prevents the worker threads from being merged or deleted while being read
+    auto_lock_t _lk(singleton_t::get_mutex());
+
+    _ret = get_results(m_storage);
+    for(auto* itr : singleton_t::children())
+    {
+        if(itr == m_storage)
+            continue;
+
+        auto _worker = get_results(itr);
+        // the bookmarks (laps == 0) are never merged into the master thread
+        _worker.erase(std::remove_if(_worker.begin(), _worker.end(),
+                                     [](const result_node& _v) {
+                                         return _v.data().get_laps() == 0;
+                                     }),
+                      _worker.end());
+        operation::finalize::merge<Type, true>(_ret, _worker);
+    }
+
+    return _ret;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+typename snapshot<Type, true>::result_type&
+snapshot<Type, true>::subtract(result_type& _lhs, const result_type& _rhs)
+{
+    std::unordered_map<uint64_t, std::vector<const result_node*>> _index{};
+    for(const auto& itr : _rhs)
+        _index[itr.hash()].emplace_back(&itr);
+
+    for(auto& itr : _lhs)
+    {
+        auto eitr = _index.find(itr.hash());
+        if(eitr == _index.end())
+            continue;
+        for(const auto* pitr : eitr->second)
+        {
+            if(*pitr == itr)
+            {
+                operation::minus<Type>(itr.data(), pitr->data());
+                itr.stats() -= pitr->stats();
+                break;
+            }
+        }
+    }
+    return _lhs;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+std::vector<std::string>
+snapshot<Type, true>::operator()(int64_t _idx)
+{
+    std::vector<std::string> _files{};
+    if(!m_storage || !trait::runtime_enabled<Type>::get())
+        return _files;
+
+    auto _settings = m_storage->m_settings;
+    if(!_settings || !_settings->get_file_output())
+        return _files;
+
+    result_type _results{};
+    (*this)(_results);
+
+    if(_settings->get_snapshot_delta())
+    {
+        auto& _prev = get_previous();
+        auto  _curr = _results;
+        subtract(_results, _prev);
+        _prev = std::move(_curr);
+    }
+
+    if(_results.empty())
+        return _files;
+
+    auto _label = Type::get_label() + ".snapshot." + std::to_string(_idx);
+    auto _rank  = dmp::rank();
+    auto _init  = dmp::is_initialized();
+    auto _dist  = distrib_type{ std::move(_results) };
+
+    // the output archive and the printer are used directly because the print
+    // operation is collective and registers the output with the manager instance of
+    // the calling thread
+    printer_type _printer{ _label, m_storage, _settings };
+
+    if(_printer.json_output())
+    {
+        using policy_type = policy::output_archive_t<Type>;
+        auto _fext        = trait::archive_extension<trait::output_archive_t<Type>>{}();
+        auto _fname       = settings::compose_output_filename(_label, _fext, _init, _rank);
+        std::ofstream ofs(_fname.c_str());
+        if(ofs)
+        {
+            {
+                // ensure write final block during destruction before the file is closed
+                auto oa = policy_type::get(ofs);
+                oa->setNextName("timemory");
+                oa->startNode();
+                operation::serialization<Type>{}(*oa, _dist);
+                oa->finishNode();
+            }
+            ofs << std::endl;
+            _files.emplace_back(_fname);
+        }
+    }
+
+    if(_printer.text_output())
+    {
+        int64_t _max_depth = 0;
+        for(const auto& itr : _dist.front())
+        {
+            if(itr.depth() < 0 || itr.depth() > _settings->get_max_depth())
+                continue;
+            _max_depth = std::max<int64_t>(_max_depth, itr.depth());
+            settings::indent_width<Type, 0>(itr.prefix().length());
+            settings::indent_width<Type, 1>(std::log10(itr.data().get_laps()) + 1);
+            settings::indent_width<Type, 2>(std::log10(itr.depth()) + 1);
+        }
+        _printer.set_max_depth(_max_depth);
+
+        auto _description = Type::get_description();
+        for(auto& itr : _description)
+            itr = toupper(itr);
+
+        typename printer_type::stream_type _stream{};
+        _printer.write_stream(_stream, _dist);
+        _stream->set_banner(_description + " [SNAPSHOT " + std::to_string(_idx) + "]");
+
+        auto _fname = settings::compose_output_filename(_label, ".txt", _init, _rank);
+        std::ofstream ofs(_fname.c_str());
+        if(ofs)
+        {
+            _printer.write(ofs, _stream);
+            _files.emplace_back(_fname);
+        }
+    }
+
+    if(_settings->get_debug() || _settings->get_verbose() > 1)
+    {
+        for(const auto& itr : _files)
+            printf("[%s]|%i> Outputting '%s'...\n", _label.c_str(), _rank, itr.c_str());
+    }
+
+    return _files;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+}  // namespace finalize
+}  // namespace operation
+}  // namespace tim
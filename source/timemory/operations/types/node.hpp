@@ -65,6 +65,11 @@ struct push_node
     : push_node(obj, _scope, get_hash_id(_key))
     {}
 
+    // hashes a string literal w/o constructing a string (at compile-time when inlined)
+    TIMEMORY_HOT_INLINE push_node(type& obj, scope::config _scope, const char* _key)
+    : push_node(obj, _scope, get_hash_id(_key))
+    {}
+
     TIMEMORY_HOT_INLINE auto operator()(type& obj, scope::config _scope,
                                         hash_value_type _hash) const
     {
@@ -83,6 +88,12 @@ struct push_node
         return (*this)(obj, _scope, get_hash_id(_key));
     }
 
+    TIMEMORY_HOT_INLINE auto operator()(type& obj, scope::config _scope,
+                                        const char* _key) const
+    {
+        return (*this)(obj, _scope, get_hash_id(_key));
+    }
+
 private:
     //  typical resolution: component
     template <typename Up, typename Vp = typename Up::value_type,
@@ -103,6 +114,14 @@ private:
             auto _storage = static_cast<storage_type*>(_obj.get_storage());
             if(_storage)
             {
+                // buffered timeline entries do not have a node until output
+                if((_scope.is_timeline() || force_time_v) &&
+                   _storage->timeline_push(_scope, &_obj, _hash))
+                {
+                    _obj.set_iterator(nullptr);
+                    _obj.set_depth_change(true);
+                    return _obj.get_iterator();
+                }
                 auto _beg_depth = _storage->depth();
                 _obj.set_iterator(_storage->insert(_scope, _obj, _hash));
                 auto _end_depth = _storage->depth();
@@ -221,6 +240,12 @@ private:
             }
             targ.set_is_running(false);
         }
+        else if(_obj.get_is_on_stack())
+        {
+            auto _storage = static_cast<storage_type*>(_obj.get_storage());
+            if(_storage && _storage->timeline_pop(&_obj))
+                _obj.set_is_on_stack(false);
+        }
         return _obj.get_iterator();
     }
 
@@ -139,7 +139,9 @@ struct print
                 utility::write_entry(_os, "SUM", _empty_data);
             if(trait::report<type>::mean())
                 utility::write_entry(_os, "MEAN", _empty_data);
-            if(trait::report<type>::stats())
+            // must match the header, i.e. no columns when statistics are not recorded
+            if(trait::report<type>::stats() && stats_enabled<Up, Statp>::value &&
+               trait::runtime_enabled<Tp>::get())
             {
                 bool use_min    = get_env<bool>("TIMEMORY_PRINT_MIN", true);
                 bool use_max    = get_env<bool>("TIMEMORY_PRINT_MIN", true);
@@ -30,6 +30,7 @@
 #include "timemory/operations/declaration.hpp"
 #include "timemory/operations/macros.hpp"
 #include "timemory/operations/types.hpp"
+#include "timemory/settings/declaration.hpp"
 #include "timemory/storage/node.hpp"
 #include "timemory/tpls/cereal/archives.hpp"
 
@@ -830,6 +831,23 @@ serialization<Tp, true>::operator()(mpi_data, mpi::comm_t comm, const ValueT& en
         return ret;
     };
 
+    //
+    //  Collect the data from all ranks with one collective operation
+    //
+    if(settings::mpi_binary_gather())
+    {
+        std::vector<std::string> _strs{};
+        if(mpi::gather(send_serialize(entry), _strs, comm_target, comm))
+        {
+            if(comm_rank != comm_target)
+                return data_type(1, entry);
+            auto _data = data_type(comm_size);
+            for(int i = 0; i < comm_size; ++i)
+                _data[i] = (i == comm_rank) ? entry : recv_serialize(_strs.at(i));
+            return _data;
+        }
+    }
+
     if(comm_rank == comm_target)
     {
         auto _data = data_type(comm_size);
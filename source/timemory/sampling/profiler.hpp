@@ -0,0 +1,490 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * \file timemory/sampling/profiler.hpp
+ * \brief Statistical call-stack profiler built on the buffered, per-thread sampler
+ */
+
+#pragma once
+
+#include "timemory/components/base.hpp"
+#include "timemory/components/timing/wall_clock.hpp"
+#include "timemory/sampling/sampler.hpp"
+#include "timemory/storage/declaration.hpp"
+#include "timemory/utility/types.hpp"
+#include "timemory/utility/utility.hpp"
+#include "timemory/variadic/lightweight_tuple.hpp"
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_UNIX)
+#    include <dlfcn.h>
+#    include <execinfo.h>
+#endif
+
+namespace tim
+{
+namespace sampling
+{
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \struct tim::sampling::call_stack
+/// \tparam Depth Maximum number of frames, including those of the signal handler
+///
+/// \brief Return addresses of a call-stack, innermost first. \ref capture is invoked in
+/// the signal handler: backtrace() only unwinds the stack after its first call, which
+/// loads the unwinder, so \ref tim::sampling::profiler calls it once before sampling
+template <size_t Depth>
+struct call_stack
+{
+    size_t                       size   = 0;
+    std::array<uintptr_t, Depth> frames = {};
+
+    static call_stack capture() noexcept
+    {
+        call_stack _v{};
+#if defined(_UNIX)
+        std::array<void*, Depth> _buffer;
+        auto _n = backtrace(_buffer.data(), static_cast<int>(Depth));
+        _v.size = (_n > 0) ? static_cast<size_t>(_n) : 0;
+        for(size_t i = 0; i < _v.size; ++i)
+            _v.frames[i] = reinterpret_cast<uintptr_t>(_buffer[i]);
+#endif
+        return _v;
+    }
+
+    /// FNV-1a hash of the frames
+    uint64_t id() const noexcept
+    {
+        uint64_t _hash = 0xcbf29ce484222325ULL;
+        for(size_t i = 0; i < size; ++i)
+        {
+            _hash ^= frames[i];
+            _hash *= 0x100000001b3ULL;
+        }
+        return _hash;
+    }
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \struct tim::sampling::stack_record
+/// \brief Component whose \ref record captures the call-stack. It is only used as the
+/// buffered record of the sampler of \ref tim::sampling::profiler
+template <size_t Depth>
+struct stack_record : public component::base<stack_record<Depth>, call_stack<Depth>>
+{
+    using value_type = call_stack<Depth>;
+    using base_type  = component::base<stack_record<Depth>, value_type>;
+
+    static std::string label() { return "call_stack"; }
+    static std::string description() { return "Sampled call-stack"; }
+    static value_type  record() noexcept { return value_type::capture(); }
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \class tim::sampling::profiler
+/// \tparam Depth Maximum number of frames per sample
+/// \tparam Tp Timing component whose storage receives the call-tree
+///
+/// \brief Samples the call-stack of the thread which invokes \ref start at a fixed rate
+/// of thread cpu-time (per-thread timers on SIGPROF, see \ref sampler::set_per_thread).
+/// The signal handler only writes the raw stack into the lock-free ring of the
+/// buffered sampler; identical stacks are deduplicated by their id when the ring is
+/// drained. \ref aggregate inserts the stacks into the call-graph of `storage<Tp>` of
+/// the calling thread below a "[sampling]" node, each function being a node whose
+/// value is the number of samples times the sampling interval and whose laps are the
+/// number of samples. \ref write_folded writes the stacks in the folded format of
+/// flamegraph.pl.
+///
+/// \code{.cpp}
+/// using profiler_t = tim::sampling::profiler<>;
+/// profiler_t::configure(1000.0);
+///
+/// profiler_t _prof{};     // one per thread
+/// _prof.start();
+/// ...
+/// _prof.stop();
+/// _prof.aggregate();
+/// _prof.write_folded("sampling.folded");
+/// \endcode
+///
+/// Function names are resolved with dladdr so the functions of the executable require
+/// linking with -rdynamic. The scheduler tick bounds the effective rate of cpu-time
+/// timers (e.g. 250 Hz with CONFIG_HZ=250).
+template <size_t Depth = 64, typename Tp = component::wall_clock>
+class profiler
+{
+    static_assert(std::is_integral<typename Tp::value_type>::value,
+                  "profiler requires a timing component with an integral value_type");
+
+public:
+    using this_type    = profiler<Depth, Tp>;
+    using stack_type   = call_stack<Depth>;
+    using record_type  = stack_record<Depth>;
+    using bundle_type  = lightweight_tuple<record_type>;
+    using sampler_type = sampler<bundle_type, 1, SIGPROF>;
+    using string_vec_t = std::vector<std::string>;
+
+    /// \struct tim::sampling::profiler::entry
+    /// \brief A unique call-stack and the number of times it was sampled
+    struct entry
+    {
+        stack_type stack  = {};
+        uint64_t   count  = 0;
+        uint64_t   stored = 0;
+    };
+
+    using entry_map_t = std::unordered_map<uint64_t, entry>;
+
+    /// \fn void configure(double, clockid_t)
+    /// \brief Sets the number of samples per second of \param _clock (thread cpu-time
+    /// by default) for all the instances. Must be called before \ref start
+    static void configure(double _rate = 1000.0,
+                          typename sampler_type::clock_id_t _clock =
+                              sampler_type::default_clock_id)
+    {
+        sampler_type::set_per_thread(true, _clock);
+        sampler_type::set_delay(1.0 / _rate);
+        sampler_type::set_rate(_rate);
+    }
+
+public:
+    explicit profiler(size_t _buffer_size = 4096)
+    : m_buffer_size{ _buffer_size }
+    {}
+
+    ~profiler() { stop(); }
+
+    profiler(const this_type&) = delete;
+    profiler(this_type&&)      = delete;
+    this_type& operator=(const this_type&) = delete;
+    this_type& operator=(this_type&&) = delete;
+
+    /// starts sampling the calling thread
+    void start();
+
+    /// stops sampling and drains the remaining samples
+    void stop();
+
+    /// moves the samples of the ring into the unique stacks, returns the number of
+    /// samples. Invoked periodically if \ref sampler::start_drain is running
+    size_t flush() { return (m_sampler) ? m_sampler->flush() : 0; }
+
+    /// inserts the samples which have not been inserted yet into the call-graph of
+    /// `storage<Tp>` of the calling thread. Returns the number of samples
+    uint64_t aggregate();
+
+    /// writes one line per unique stack, "outer;...;inner <count>"
+    void write_folded(std::ostream& _os) const;
+    bool write_folded(const std::string& _fname) const;
+
+    /// the function names of a stack (outermost first), the frames of the signal
+    /// handler are excluded
+    string_vec_t get_names(const stack_type& _stack) const;
+
+    entry_map_t get_stacks() const
+    {
+        std::unique_lock<std::mutex> _lk(m_mutex);
+        return m_stacks;
+    }
+
+    uint64_t get_samples() const
+    {
+        std::unique_lock<std::mutex> _lk(m_mutex);
+        return m_samples;
+    }
+
+    size_t get_dropped() const
+    {
+        return (m_sampler && m_sampler->get_buffer()) ? m_sampler->get_buffer()->dropped()
+                                                      : 0;
+    }
+
+    bool is_running() const { return m_running; }
+
+private:
+    void add(const stack_type& _stack);
+
+    static std::string get_name(uintptr_t _addr);
+
+    /// the address the signal handler returns to
+    static uintptr_t& get_trampoline()
+    {
+        static uintptr_t _value = 0;
+        return _value;
+    }
+
+private:
+    using name_map_t = std::unordered_map<uintptr_t, std::string>;
+
+    bool                          m_running     = false;
+    size_t                        m_buffer_size = 4096;
+    uint64_t                      m_samples     = 0;
+    mutable std::mutex            m_mutex       = {};
+    entry_map_t                   m_stacks      = {};
+    std::unique_ptr<sampler_type> m_sampler     = {};
+    mutable name_map_t            m_names       = {};
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+template <size_t Depth, typename Tp>
+void
+profiler<Depth, Tp>::start()
+{
+    if(m_running)
+        return;
+
+    // load the unwinder outside of the signal handler
+    consume_parameters(stack_type::capture());
+
+    if(!m_sampler)
+    {
+        m_sampler = std::make_unique<sampler_type>("profiler", std::set<int>{ SIGPROF });
+        m_sampler->enable_buffer(m_buffer_size);
+        m_sampler->set_record_callback(
+            [this](const typename sampler_type::record_t& _record) {
+                add(_record.value);
+            });
+    }
+
+    m_running = true;
+    m_sampler->start();
+
+#if defined(_LINUX)
+    // the kernel makes the handler return to the restorer which glibc installs so it
+    // is the frame which separates the handler from the interrupted code
+    struct sigaction _sa;
+    if(sigaction(SIGPROF, nullptr, &_sa) == 0 && _sa.sa_restorer != nullptr)
+        get_trampoline() = reinterpret_cast<uintptr_t>(_sa.sa_restorer);
+#endif
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <size_t Depth, typename Tp>
+void
+profiler<Depth, Tp>::stop()
+{
+    if(!m_running)
+        return;
+    m_running = false;
+    m_sampler->stop();
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <size_t Depth, typename Tp>
+void
+profiler<Depth, Tp>::add(const stack_type& _stack)
+{
+    if(_stack.size == 0)
+        return;
+    std::unique_lock<std::mutex> _lk(m_mutex);
+    auto&                        _entry = m_stacks[_stack.id()];
+    if(_entry.count == 0)
+        _entry.stack = _stack;
+    ++_entry.count;
+    ++m_samples;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <size_t Depth, typename Tp>
+std::string
+profiler<Depth, Tp>::get_name(uintptr_t _addr)
+{
+#if defined(_UNIX)
+    Dl_info _info;
+    if(dladdr(reinterpret_cast<void*>(_addr), &_info) != 0)
+    {
+        if(_info.dli_sname)
+            return demangle(_info.dli_sname);
+        if(_info.dli_fname)
+        {
+            std::stringstream _ss;
+            std::string       _fname = _info.dli_fname;
+            _ss << _fname.substr(_fname.find_last_of('/') + 1) << "+0x" << std::hex
+                << (_addr - reinterpret_cast<uintptr_t>(_info.dli_fbase));
+            return _ss.str();
+        }
+    }
+#endif
+    std::stringstream _ss;
+    _ss << "0x" << std::hex << _addr;
+    return _ss.str();
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <size_t Depth, typename Tp>
+typename profiler<Depth, Tp>::string_vec_t
+profiler<Depth, Tp>::get_names(const stack_type& _stack) const
+{
+    auto _resolve = [&](uintptr_t _addr) -> const std::string& {
+        auto itr = m_names.find(_addr);
+        if(itr == m_names.end())
+            itr = m_names.emplace(_addr, get_name(_addr)).first;
+        return itr->second;
+    };
+
+    // find the first frame of the interrupted code: after the restorer if it is known,
+    // otherwise after the frames of the sampler
+    size_t _begin    = 0;
+    auto   _restorer = get_trampoline();
+    for(size_t i = 0; i < _stack.size; ++i)
+    {
+        if(_restorer != 0 && _stack.frames[i] == _restorer)
+        {
+            _begin = i + 1;
+            break;
+        }
+        else if(_restorer == 0 && _resolve(_stack.frames[i]).find("tim::sampling::") == 0)
+        {
+            _begin = i + 1;
+        }
+    }
+
+    string_vec_t _names{};
+    _names.reserve(_stack.size - std::min(_begin, _stack.size));
+    for(size_t i = _stack.size; i > _begin; --i)
+    {
+        // the interrupted frame holds the exact address, the others the return address
+        auto _addr = _stack.frames[i - 1];
+        _names.emplace_back(_resolve((i - 1 == _begin) ? _addr : _addr - 1));
+    }
+    return _names;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <size_t Depth, typename Tp>
+uint64_t
+profiler<Depth, Tp>::aggregate()
+{
+    flush();
+
+    auto* _storage = storage<Tp>::instance();
+    if(!_storage)
+        return 0;
+
+    auto _interval = sampler_type::get_frequency(units::nsec);
+    auto _add      = [](typename storage<Tp>::iterator _itr, uint64_t _count,
+                   int64_t _value) {
+        auto& _obj = _itr->obj();
+        _obj += _value;
+        _obj.set_laps(_obj.get_laps() + _count);
+    };
+
+    std::unique_lock<std::mutex> _lk(m_mutex);
+
+    uint64_t _total = 0;
+    for(auto& itr : m_stacks)
+        _total += itr.second.count - itr.second.stored;
+    if(_total == 0)
+        return 0;
+
+    auto _root = _storage->insert(scope::config{ scope::tree{} }, Tp{},
+                                  add_hash_id("[sampling]"));
+    _storage->pop();
+    _add(_root, _total, _total * _interval);
+
+    for(auto& itr : m_stacks)
+    {
+        auto _count = itr.second.count - itr.second.stored;
+        if(_count == 0)
+            continue;
+        itr.second.stored = itr.second.count;
+
+        auto _value = static_cast<int64_t>(_count * _interval);
+        auto _itr   = _root;
+        for(const auto& nitr : get_names(itr.second.stack))
+        {
+            Tp _obj{};
+            _itr = _storage->append(
+                typename storage<Tp>::template secondary_data_t<Tp>{ _itr, nitr, _obj });
+            _add(_itr, _count, _value);
+        }
+    }
+    return _total;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <size_t Depth, typename Tp>
+void
+profiler<Depth, Tp>::write_folded(std::ostream& _os) const
+{
+    // sort by the folded stack so that the output is deterministic
+    std::map<std::string, uint64_t> _folded{};
+    {
+        std::unique_lock<std::mutex> _lk(m_mutex);
+        for(const auto& itr : m_stacks)
+        {
+            std::stringstream _ss;
+            for(const auto& nitr : get_names(itr.second.stack))
+            {
+                if(_ss.tellp() > 0)
+                    _ss << ';';
+                _ss << nitr;
+            }
+            _folded[_ss.str()] += itr.second.count;
+        }
+    }
+
+    for(const auto& itr : _folded)
+        _os << itr.first << ' ' << itr.second << '\n';
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <size_t Depth, typename Tp>
+bool
+profiler<Depth, Tp>::write_folded(const std::string& _fname) const
+{
+    std::ofstream _ofs{ _fname };
+    if(!_ofs)
+        return false;
+    write_folded(_ofs);
+    return true;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+}  // namespace sampling
+}  // namespace tim
@@ -0,0 +1,243 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * \file timemory/sampling/sample_buffer.hpp
+ * \brief Fixed-capacity lock-free ring of sample records which can be written from a
+ * signal handler
+ */
+
+#pragma once
+
+#include "timemory/utility/macros.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace tim
+{
+namespace sampling
+{
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \struct tim::sampling::is_recordable
+/// \brief Whether a measurement of the component can be taken in a signal handler and
+/// stored in a \ref tim::sampling::sample_record, i.e. the component provides a
+/// static `record()` returning a trivially copyable `value_type`
+template <typename Tp, typename = void>
+struct is_recordable : std::false_type
+{};
+//
+template <typename Tp>
+struct is_recordable<Tp, decltype(static_cast<void>(Tp::record()))>
+: std::integral_constant<
+      bool, std::is_trivially_copyable<typename Tp::value_type>::value &&
+                std::is_convertible<decltype(Tp::record()),
+                                    typename Tp::value_type>::value>
+{};
+//
+/// \struct tim::sampling::are_recordable
+/// \brief Whether all the components are \ref is_recordable
+template <typename... Types>
+struct are_recordable;
+//
+template <>
+struct are_recordable<> : std::true_type
+{};
+//
+template <typename Tp, typename... Tail>
+struct are_recordable<Tp, Tail...>
+: std::integral_constant<bool, is_recordable<Tp>::value &&
+                                   are_recordable<Tail...>::value>
+{};
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \struct tim::sampling::sample_record
+/// \tparam Types Components (all \ref is_recordable)
+///
+/// \brief Trivially copyable record of the `record()` value of each component. \ref
+/// capture is invoked in the signal handler and \ref apply later sets the values on a
+/// bundle of the same components
+template <typename... Types>
+struct sample_record;
+//
+template <>
+struct sample_record<>
+{
+    void capture() noexcept {}
+
+    template <typename BundleT>
+    void apply(BundleT&) const
+    {}
+};
+//
+template <typename Tp, typename... Tail>
+struct sample_record<Tp, Tail...>
+{
+    static_assert(is_recordable<Tp>::value,
+                  "sample_record requires components with a static record() returning "
+                  "a trivially copyable value_type");
+
+    typename Tp::value_type value;
+    sample_record<Tail...>  tail;
+
+    void capture() noexcept
+    {
+        value = Tp::record();
+        tail.capture();
+    }
+
+    template <typename BundleT>
+    void apply(BundleT& _bundle) const
+    {
+        auto* _obj = _bundle.template get<Tp>();
+        if(_obj)
+        {
+            _obj->set_value(value);
+            _obj->set_accum(value);
+        }
+        tail.apply(_bundle);
+    }
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \class tim::sampling::sample_buffer
+/// \tparam Tp Trivially copyable record type
+///
+/// \brief Single-producer/single-consumer ring holding up to \ref capacity records
+/// (rounded up to a power of two). The storage is allocated once in the constructor and
+/// \ref write only uses atomic loads and stores so it is async-signal-safe. When the ring
+/// is full, or when another producer is already writing (e.g. the process-wide itimer
+/// delivered the signal to two threads at once), the record is dropped and counted
+/// instead of blocking. Calls to \ref drain must be serialized by the caller.
+template <typename Tp>
+class sample_buffer
+{
+    static_assert(std::is_trivially_copyable<Tp>::value,
+                  "sample_buffer requires a trivially copyable record type");
+
+public:
+    using this_type  = sample_buffer<Tp>;
+    using value_type = Tp;
+    using size_type  = size_t;
+
+public:
+    explicit sample_buffer(size_type _capacity)
+    : m_capacity{ round_up(_capacity) }
+    , m_data{ new Tp[m_capacity] }
+    {}
+
+    ~sample_buffer() = default;
+
+    sample_buffer(const this_type&) = delete;
+    sample_buffer(this_type&&)      = delete;
+    this_type& operator=(const this_type&) = delete;
+    this_type& operator=(this_type&&) = delete;
+
+    /// producer, returns false if the record was dropped
+    bool write(const Tp& _v) noexcept
+    {
+        if(m_writing.test_and_set(std::memory_order_acquire))
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        auto _head = m_head.load(std::memory_order_relaxed);
+        bool _room = (_head - m_tail.load(std::memory_order_acquire)) < m_capacity;
+        if(_room)
+        {
+            m_data[_head & (m_capacity - 1)] = _v;
+            m_head.store(_head + 1, std::memory_order_release);
+        }
+        else
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        m_writing.clear(std::memory_order_release);
+        return _room;
+    }
+
+    /// consumer, invokes \param _func with each record in the order they were written
+    /// and returns the number of records
+    template <typename FuncT>
+    size_type drain(FuncT&& _func)
+    {
+        auto _tail = m_tail.load(std::memory_order_relaxed);
+        auto _head = m_head.load(std::memory_order_acquire);
+        for(auto i = _tail; i != _head; ++i)
+            _func(m_data[i & (m_capacity - 1)]);
+        m_tail.store(_head, std::memory_order_release);
+        return _head - _tail;
+    }
+
+    /// number of records which have not been drained
+    TIMEMORY_NODISCARD size_type size() const
+    {
+        return m_head.load(std::memory_order_acquire) -
+               m_tail.load(std::memory_order_acquire);
+    }
+
+    TIMEMORY_NODISCARD size_type capacity() const { return m_capacity; }
+    TIMEMORY_NODISCARD bool      empty() const { return size() == 0; }
+
+    /// number of records which were discarded
+    TIMEMORY_NODISCARD size_type dropped() const
+    {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    static size_type round_up(size_type _n)
+    {
+        size_type _v = 1;
+        while(_v < _n)
+            _v <<= 1;
+        return _v;
+    }
+
+private:
+    // the producer and the consumer indices are on separate cache lines
+    std::atomic_flag       m_writing = ATOMIC_FLAG_INIT;
+    std::atomic<size_type> m_head{ 0 };
+    char                   m_head_pad[64 - sizeof(std::atomic<size_type>)];
+    std::atomic<size_type> m_tail{ 0 };
+    char                   m_tail_pad[64 - sizeof(std::atomic<size_type>)];
+    std::atomic<size_type> m_dropped{ 0 };
+    size_type              m_capacity = 0;
+    std::unique_ptr<Tp[]>  m_data     = {};
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+}  // namespace sampling
+}  // namespace tim
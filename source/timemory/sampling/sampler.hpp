@@ -26,6 +26,7 @@
 
 #include "timemory/components/base.hpp"
 #include "timemory/mpl/apply.hpp"
+#include "timemory/sampling/sample_buffer.hpp"
 #include "timemory/settings/declaration.hpp"
 #include "timemory/units.hpp"
 #include "timemory/utility/utility.hpp"
@@ -35,10 +36,13 @@
 #include <algorithm>
 #include <array>
 #include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <thread>
 #include <type_traits>
 #include <utility>
@@ -66,6 +70,15 @@ extern "C"
 }
 #endif
 
+#if defined(_LINUX)
+#    include <sys/syscall.h>
+#    include <time.h>
+// older glibc versions do not define the member name
+#    if !defined(sigev_notify_thread_id)
+#        define sigev_notify_thread_id _sigev_un._tid
+#    endif
+#endif
+
 namespace tim
 {
 namespace sampling
@@ -153,6 +166,34 @@ using fixed_sig_t = typename fixed_sig<Ids...>::type;
 /// sampler_t::ignore({ SIGALRM });         // ignore future interrupts
 /// sampler_t::wait(process::target_pid()); // wait for pid to finish
 /// \endcode
+///
+/// By default, one process-wide interval timer (setitimer) delivers the signals so they
+/// land on whichever thread happens to be running. After
+/// \ref set_per_thread (Linux only), every thread which starts a sampler instance
+/// gets its own POSIX timer which delivers the signal to that thread and only the
+/// instances created on that thread take a sample:
+/// \code{.cpp}
+/// sample_t::set_per_thread(true, CLOCK_THREAD_CPUTIME_ID);  // rate ~ thread cpu-time
+/// sample_t::configure({ SIGPROF });
+///
+/// // on each thread
+/// sample_t _sampler{ "thread", { SIGPROF } };
+/// _sampler.start();   // creates the timer of the calling thread
+/// ...
+/// _sampler.stop();    // deletes it (or when the thread exits)
+/// \endcode
+///
+/// At high sampling rates, \ref enable_buffer keeps the signal handler from touching
+/// the bundles: it only writes the `record()` values of the components into a
+/// fixed-capacity lock-free ring which a background thread moves into the bundles:
+/// \code{.cpp}
+/// sample_t::start_drain(0.01);    // flush the rings every 10 ms
+/// _sampler.enable_buffer(4096);
+/// _sampler.start();
+/// ...
+/// _sampler.stop();                // flushes the remaining records
+/// sample_t::stop_drain();
+/// \endcode
 template <template <typename...> class CompT, size_t N, typename... Types, int... SigIds>
 struct sampler<CompT<Types...>, N, SigIds...>
 : component::base<sampler<CompT<Types...>, N, SigIds...>, void>
@@ -169,11 +210,26 @@ struct sampler<CompT<Types...>, N, SigIds...>
     using array_type   = array_t;
     using tracker_type = policy::instance_tracker<this_type, false>;
 
+    /// record written by the signal handler in buffered mode, see \ref enable_buffer
+    using record_t =
+        conditional_t<are_recordable<remove_pointer_t<Types>...>::value,
+                      sample_record<remove_pointer_t<Types>...>, sample_record<>>;
+    using buffer_t          = sample_buffer<record_t>;
+    using record_callback_t = std::function<void(const record_t&)>;
+
     static void  execute(int signum);
     static void  execute(int signum, siginfo_t*, void*);
     static auto& get_samplers() { return get_persistent_data().m_instances; }
     static auto  get_latest_samples();
 
+#if defined(_LINUX)
+    using clock_id_t = clockid_t;
+    static constexpr clock_id_t default_clock_id = CLOCK_THREAD_CPUTIME_ID;
+#else
+    using clock_id_t = int;
+    static constexpr clock_id_t default_clock_id = 0;
+#endif
+
 public:
     template <typename Tp = fixed_size_t<N>, enable_if_t<Tp::value> = 0>
     sampler(const std::string& _label, signal_set_t _good,
@@ -218,6 +274,9 @@ public:
     auto backtrace_enabled() const { return m_backtrace; }
     void enable_backtrace(bool val) { m_backtrace = val; }
 
+    /// thread which created the instance, see \ref set_per_thread
+    auto get_thread_id() const { return m_tid; }
+
     components_t*& get_last() { return m_last; }
     components_t*  get_last() const { return m_last; }
 
@@ -246,7 +305,7 @@ public:
     static TIMEMORY_INLINE void configure(std::set<int> _signals, int _verbose = 1);
     static TIMEMORY_INLINE void configure(int _signal = SIGALRM, int _verbose = 1)
     {
-        configure({ _signal }, _verbose);
+        configure(std::set<int>{ _signal }, _verbose);
     }
 
     /// \fn void ignore(const std::set<int>& _signals)
@@ -258,7 +317,11 @@ public:
     /// \fn void clear()
     /// \brief Clear all signals. Recommended to call ignore() prior to clearing all the
     /// signals
-    static void clear() { get_persistent_data().m_signals.clear(); }
+    static void clear()
+    {
+        get_persistent_data().m_signals.clear();
+        get_persistent_data().m_active = false;
+    }
 
     /// \fn void pause()
     /// \brief Pause until a signal is delivered
@@ -345,13 +408,72 @@ public:
     /// \brief Checks to see if there was an error setting or getting itimer val
     static bool check_itimer(int _stat, bool _throw_exception = false);
 
+    /// \fn void set_per_thread(bool, clock_id_t)
+    /// \brief Use a POSIX timer per thread measuring \param _clock instead of the
+    /// process-wide itimer: CLOCK_THREAD_CPUTIME_ID samples each thread in proportion to
+    /// its cpu-time and CLOCK_MONOTONIC at a fixed real-time rate. Must be set before
+    /// \ref configure. Only supported on Linux, returns false otherwise
+    static bool set_per_thread(bool _value, clock_id_t _clock = default_clock_id);
+
+    /// \fn bool get_per_thread()
+    /// \brief Whether each thread has its own timer
+    static bool get_per_thread() { return get_persistent_data().m_per_thread; }
+
+    /// \fn size_t start_thread_timer()
+    /// \brief Creates the timers of the calling thread for the configured signals when
+    /// per-thread timers are enabled. Invoked by \ref start, calls are reference-counted
+    /// per thread. Returns the number of timers of the thread
+    static size_t start_thread_timer();
+
+    /// \fn void stop_thread_timer()
+    /// \brief Deletes the timers of the calling thread once every \ref
+    /// start_thread_timer has been matched. Invoked by \ref stop and when the thread
+    /// exits
+    static void stop_thread_timer();
+
+    /// \fn void enable_buffer(size_t)
+    /// \brief Instead of sampling the bundles in the signal handler, write the
+    /// `record()` value of each component into a lock-free ring of \param _capacity
+    /// records. The records are moved into the bundles by \ref flush, which is invoked
+    /// by \ref stop and periodically by the thread of \ref start_drain. Requires
+    /// components which are \ref is_recordable, must be called before \ref start and
+    /// does not record backtraces
+    void enable_buffer(size_t _capacity = 1024);
+
+    /// \fn buffer_t* get_buffer() const
+    /// \brief The ring of the buffered mode, nullptr if not enabled
+    buffer_t* get_buffer() const { return m_buffer.get(); }
+
+    /// \fn void set_record_callback(record_callback_t)
+    /// \brief In buffered mode, hand the drained records to \param _func instead of
+    /// writing them into the bundles, e.g. to aggregate them. The callback is invoked
+    /// while the type mutex is held, possibly from the drain thread
+    void set_record_callback(record_callback_t _func);
+
+    /// \fn size_t flush()
+    /// \brief Moves the buffered records into the bundles. Returns the number of
+    /// records
+    size_t flush();
+
+    /// \fn void start_drain(double)
+    /// \brief Starts a background thread which flushes all the buffered samplers every
+    /// \param _interval seconds so that the rings do not overflow
+    static void start_drain(double _interval = 0.01);
+
+    /// \fn void stop_drain()
+    /// \brief Stops the background thread and flushes all the buffered samplers
+    static void stop_drain();
+
 protected:
-    bool          m_backtrace = false;
-    size_t        m_idx       = 0;
-    components_t* m_last      = nullptr;
-    signal_set_t  m_good      = {};
-    signal_set_t  m_bad       = {};
-    array_t       m_data      = {};
+    bool                      m_backtrace       = false;
+    int64_t                   m_tid             = threading::get_id();
+    size_t                    m_idx             = 0;
+    components_t*             m_last            = nullptr;
+    signal_set_t              m_good            = {};
+    signal_set_t              m_bad             = {};
+    array_t                   m_data            = {};
+    std::unique_ptr<buffer_t> m_buffer          = {};
+    record_callback_t         m_record_callback = {};
 
 private:
     using sigaction_t = struct sigaction;
@@ -359,8 +481,10 @@ private:
 
     struct persistent_data
     {
-        bool                    m_active = false;
-        int                     m_flags  = SA_RESTART | SA_SIGINFO;
+        bool                    m_active     = false;
+        bool                    m_per_thread = false;
+        clock_id_t              m_clock      = default_clock_id;
+        int                     m_flags      = SA_RESTART | SA_SIGINFO;
         double                  m_delay  = 0.001;
         double                  m_freq   = 1.0 / 2.0;
         sigaction_t             m_custom_sigaction;
@@ -369,11 +493,62 @@ private:
         itimerval_t             m_original_itimerval;
         std::set<int>           m_signals   = {};
         std::vector<this_type*> m_instances = {};
+        // background drain of the buffered samplers
+        bool                    m_drain_stop     = false;
+        double                  m_drain_interval = 0.01;
+        std::thread             m_drain_thread   = {};
+        std::mutex              m_drain_mutex    = {};
+        std::condition_variable m_drain_cv       = {};
+
+        ~persistent_data() { stop_drain(); }
     };
 
     static persistent_data& get_persistent_data()
     {
+        // the drain thread locks the type mutex so it must outlive this instance
+        static auto&           _mutex = type_mutex<this_type>();
         static persistent_data _instance;
+        consume_parameters(_mutex);
+        return _instance;
+    }
+
+    /// writes a record into the ring in the signal handler
+    void record_sample()
+    {
+        record_t _record;
+        _record.capture();
+        m_buffer->write(_record);
+    }
+
+    /// moves the records into the bundles, the type mutex must be held
+    size_t drain_buffer();
+
+    /// the bundle which receives the next sample
+    template <typename Tp = fixed_size_t<N>, enable_if_t<Tp::value> = 0>
+    components_t* next_sample();
+
+    template <typename Tp = fixed_size_t<N>, enable_if_t<!Tp::value> = 0>
+    components_t* next_sample();
+
+#if defined(_LINUX)
+    using timer_vec_t = std::vector<timer_t>;
+#else
+    using timer_vec_t = std::vector<int>;
+#endif
+
+    /// timers of the calling thread, deleted when the thread exits
+    struct thread_timer
+    {
+        int64_t     m_count  = 0;
+        timer_vec_t m_timers = {};
+
+        ~thread_timer() { clear(); }
+        void clear();
+    };
+
+    static thread_timer& get_thread_timer()
+    {
+        static thread_local thread_timer _instance{};
         return _instance;
     }
 
@@ -454,7 +629,7 @@ sampler<CompT<Types...>, N, SigIds...>::sample()
 {
     // if(!base_type::get_is_running())
     //    return;
-    m_last = &(m_data.at((m_idx++) % N));
+    m_last = next_sample();
     // get last 4 of 7 backtrace entries (i.e. offset by 3)
     if(m_backtrace)
     {
@@ -475,8 +650,7 @@ sampler<CompT<Types...>, N, SigIds...>::sample()
 {
     // if(!base_type::get_is_running())
     //    return;
-    m_last = &m_data.back();
-    m_data.emplace_back(components_t(m_last->hash()));
+    m_last = next_sample();
     // get last 4 of 7 backtrace entries (i.e. offset by 3)
     if(m_backtrace)
     {
@@ -501,6 +675,8 @@ sampler<CompT<Types...>, N, SigIds...>::start()
         itr.start();
     if(cnt == 0)
         configure({ SigIds... });
+    if(get_persistent_data().m_per_thread)
+        start_thread_timer();
 }
 //
 //--------------------------------------------------------------------------------------//
@@ -514,8 +690,12 @@ sampler<CompT<Types...>, N, SigIds...>::stop()
     base_type::set_stopped();
     for(auto& itr : m_data)
         itr.stop();
+    if(get_persistent_data().m_per_thread)
+        stop_thread_timer();
     if(cnt == 0)
         ignore({ SigIds... });
+    if(m_buffer)
+        flush();
 }
 //
 //--------------------------------------------------------------------------------------//
@@ -528,6 +708,8 @@ sampler<CompT<Types...>, N, SigIds...>::start()
     base_type::set_started();
     for(auto& itr : m_data)
         itr.start();
+    if(get_persistent_data().m_per_thread)
+        start_thread_timer();
 }
 //
 //--------------------------------------------------------------------------------------//
@@ -540,6 +722,10 @@ sampler<CompT<Types...>, N, SigIds...>::stop()
     base_type::set_stopped();
     for(auto& itr : m_data)
         itr.stop();
+    if(get_persistent_data().m_per_thread)
+        stop_thread_timer();
+    if(m_buffer)
+        flush();
 }
 //
 //--------------------------------------------------------------------------------------//
@@ -594,11 +780,21 @@ sampler<CompT<Types...>, N, SigIds...>::execute(int signum)
                (int) threading::get_id(), demangle<this_type>().c_str());
     }
 
+    // with per-thread timers, the signal is delivered to the thread being sampled
+    bool    _per_thread = get_persistent_data().m_per_thread;
+    int64_t _tid        = (_per_thread) ? threading::get_id() : 0;
+
     for(auto& itr : get_samplers())
     {
+        if(_per_thread && itr->m_tid != _tid)
+            continue;
+
         if(itr->is_good(signum))
         {
-            itr->sample();
+            if(itr->m_buffer)
+                itr->record_sample();
+            else
+                itr->sample();
         }
         else if(itr->is_bad(signum))
         {
@@ -624,11 +820,21 @@ sampler<CompT<Types...>, N, SigIds...>::execute(int signum, siginfo_t*, void*)
                (int) threading::get_id(), demangle<this_type>().c_str());
     }
 
+    // with per-thread timers, the signal is delivered to the thread being sampled
+    bool    _per_thread = get_persistent_data().m_per_thread;
+    int64_t _tid        = (_per_thread) ? threading::get_id() : 0;
+
     for(auto& itr : get_samplers())
     {
+        if(_per_thread && itr->m_tid != _tid)
+            continue;
+
         if(itr->is_good(signum))
         {
-            itr->sample();
+            if(itr->m_buffer)
+                itr->record_sample();
+            else
+                itr->sample();
         }
         else if(itr->is_bad(signum))
         {
@@ -689,9 +895,26 @@ sampler<CompT<Types...>, N, SigIds...>::configure(std::set<int> _signals, int _v
         _custom_sa.sa_sigaction = &this_type::execute;
         _custom_sa.sa_flags     = SA_RESTART | SA_SIGINFO;
 
+        // do not let the handler interrupt itself for another sampled signal
+        sigemptyset(&_custom_sa.sa_mask);
+        for(auto& itr : _signals)
+            sigaddset(&_custom_sa.sa_mask, itr);
+
         // start the interval timer
         for(auto& itr : _signals)
         {
+            // the timers are created by each thread in start_thread_timer
+            if(get_persistent_data().m_per_thread)
+            {
+                if(sigaction(itr, &_custom_sa, &_original_sa) != 0)
+                {
+                    TIMEMORY_EXCEPTION(TIMEMORY_JOIN(
+                        " ", "Error! sigaction could not be set for signal", itr));
+                }
+                get_persistent_data().m_signals.insert(itr);
+                continue;
+            }
+
             // get the associated itimer type
             auto _itimer = get_itimer(itr);
             if(_itimer < 0)
@@ -744,6 +967,10 @@ sampler<CompT<Types...>, N, SigIds...>::ignore(const std::set<int>& _signals)
             check_itimer(setitimer(_itimer, &_original_it, &_curr));
     }
 
+    // ignored signals are re-installed by the next configure
+    for(const auto& itr : _signals)
+        get_persistent_data().m_signals.erase(itr);
+
     // if active field based on whether there are signals
     get_persistent_data().m_active = !get_persistent_data().m_signals.empty();
 }
@@ -1032,5 +1259,219 @@ sampler<CompT<Types...>, N, SigIds...>::check_itimer(int _stat, bool _throw_exce
 //
 //--------------------------------------------------------------------------------------//
 //
+template <template <typename...> class CompT, size_t N, typename... Types, int... SigIds>
+bool
+sampler<CompT<Types...>, N, SigIds...>::set_per_thread(bool _value, clock_id_t _clock)
+{
+#if defined(_LINUX)
+    get_persistent_data().m_per_thread = _value;
+    get_persistent_data().m_clock      = _clock;
+    return true;
+#else
+    consume_parameters(_clock);
+    get_persistent_data().m_per_thread = false;
+    return !_value;
+#endif
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <template <typename...> class CompT, size_t N, typename... Types, int... SigIds>
+size_t
+sampler<CompT<Types...>, N, SigIds...>::start_thread_timer()
+{
+    auto& _data  = get_persistent_data();
+    auto& _timer = get_thread_timer();
+    ++_timer.m_count;
+    if(!_timer.m_timers.empty() || !_data.m_active || !_data.m_per_thread)
+        return _timer.m_timers.size();
+
+#if defined(_LINUX)
+    auto _to_timespec = [](const struct timeval& _tv) {
+        struct timespec _ts;
+        _ts.tv_sec  = _tv.tv_sec;
+        _ts.tv_nsec = _tv.tv_usec * 1000;
+        return _ts;
+    };
+
+    struct itimerspec _spec;
+    _spec.it_value    = _to_timespec(_data.m_custom_itimerval.it_value);
+    _spec.it_interval = _to_timespec(_data.m_custom_itimerval.it_interval);
+    // a zero value disarms the timer
+    if(_spec.it_value.tv_sec == 0 && _spec.it_value.tv_nsec == 0)
+        _spec.it_value = _spec.it_interval;
+
+    for(const auto& itr : _data.m_signals)
+    {
+        struct sigevent _event;
+        memset(&_event, 0, sizeof(_event));
+        _event.sigev_notify           = SIGEV_THREAD_ID;
+        _event.sigev_signo            = itr;
+        _event.sigev_notify_thread_id = static_cast<pid_t>(syscall(SYS_gettid));
+
+        timer_t _id;
+        if(timer_create(_data.m_clock, &_event, &_id) != 0)
+        {
+            perror("[timemory]> sampler could not create the thread timer");
+            continue;
+        }
+        if(timer_settime(_id, 0, &_spec, nullptr) != 0)
+        {
+            perror("[timemory]> sampler could not start the thread timer");
+            timer_delete(_id);
+            continue;
+        }
+        _timer.m_timers.emplace_back(_id);
+    }
+#endif
+    return _timer.m_timers.size();
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <template <typename...> class CompT, size_t N, typename... Types, int... SigIds>
+void
+sampler<CompT<Types...>, N, SigIds...>::stop_thread_timer()
+{
+    auto& _timer = get_thread_timer();
+    if(_timer.m_count > 0 && --_timer.m_count == 0)
+        _timer.clear();
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <template <typename...> class CompT, size_t N, typename... Types, int... SigIds>
+void
+sampler<CompT<Types...>, N, SigIds...>::thread_timer::clear()
+{
+#if defined(_LINUX)
+    for(auto& itr : m_timers)
+        timer_delete(itr);
+#endif
+    m_timers.clear();
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <template <typename...> class CompT, size_t N, typename... Types, int... SigIds>
+template <typename Tp, enable_if_t<Tp::value>>
+typename sampler<CompT<Types...>, N, SigIds...>::components_t*
+sampler<CompT<Types...>, N, SigIds...>::next_sample()
+{
+    return &(m_data.at((m_idx++) % N));
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <template <typename...> class CompT, size_t N, typename... Types, int... SigIds>
+template <typename Tp, enable_if_t<!Tp::value>>
+typename sampler<CompT<Types...>, N, SigIds...>::components_t*
+sampler<CompT<Types...>, N, SigIds...>::next_sample()
+{
+    // the last entry receives the sample and a new one is appended. The pointer is
+    // taken after the append since it may reallocate
+    m_data.emplace_back(components_t(m_data.back().hash()));
+    return &m_data.at(m_data.size() - 2);
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <template <typename...> class CompT, size_t N, typename... Types, int... SigIds>
+void
+sampler<CompT<Types...>, N, SigIds...>::enable_buffer(size_t _capacity)
+{
+    static_assert(are_recordable<remove_pointer_t<Types>...>::value,
+                  "buffered sampling requires components with a static record() "
+                  "returning a trivially copyable value_type");
+
+    auto_lock_t lk(type_mutex<this_type>());
+    m_buffer = std::make_unique<buffer_t>(std::max<size_t>(_capacity, 1));
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <template <typename...> class CompT, size_t N, typename... Types, int... SigIds>
+void
+sampler<CompT<Types...>, N, SigIds...>::set_record_callback(record_callback_t _func)
+{
+    auto_lock_t lk(type_mutex<this_type>());
+    m_record_callback = std::move(_func);
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <template <typename...> class CompT, size_t N, typename... Types, int... SigIds>
+size_t
+sampler<CompT<Types...>, N, SigIds...>::flush()
+{
+    auto_lock_t lk(type_mutex<this_type>());
+    return drain_buffer();
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <template <typename...> class CompT, size_t N, typename... Types, int... SigIds>
+size_t
+sampler<CompT<Types...>, N, SigIds...>::drain_buffer()
+{
+    if(!m_buffer)
+        return 0;
+    if(m_record_callback)
+        return m_buffer->drain(m_record_callback);
+    return m_buffer->drain([this](const record_t& _record) {
+        m_last = next_sample();
+        _record.apply(*m_last);
+    });
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <template <typename...> class CompT, size_t N, typename... Types, int... SigIds>
+void
+sampler<CompT<Types...>, N, SigIds...>::start_drain(double _interval)
+{
+    auto& _data = get_persistent_data();
+    if(_data.m_drain_thread.joinable())
+        return;
+
+    _data.m_drain_stop     = false;
+    _data.m_drain_interval = _interval;
+    _data.m_drain_thread   = std::thread([&_data]() {
+        auto _interval = std::chrono::duration<double>(_data.m_drain_interval);
+        std::unique_lock<std::mutex> _lk(_data.m_drain_mutex);
+        while(!_data.m_drain_stop)
+        {
+            _data.m_drain_cv.wait_for(_lk, _interval);
+            auto_lock_t _type_lk(type_mutex<this_type>());
+            for(auto& itr : _data.m_instances)
+                itr->drain_buffer();
+        }
+    });
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <template <typename...> class CompT, size_t N, typename... Types, int... SigIds>
+void
+sampler<CompT<Types...>, N, SigIds...>::stop_drain()
+{
+    auto& _data = get_persistent_data();
+    if(!_data.m_drain_thread.joinable())
+        return;
+
+    {
+        std::unique_lock<std::mutex> _lk(_data.m_drain_mutex);
+        _data.m_drain_stop = true;
+    }
+    _data.m_drain_cv.notify_all();
+    _data.m_drain_thread.join();
+
+    auto_lock_t _type_lk(type_mutex<this_type>());
+    for(auto& itr : _data.m_instances)
+        itr->drain_buffer();
+}
+//
+//--------------------------------------------------------------------------------------//
+//
 }  // namespace sampling
 }  // namespace tim
@@ -609,6 +609,18 @@ settings::initialize_io()
         "Write a CTestNotes.txt for each text output", false,
         strvector_t({ "--timemory-ctest-notes" }), -1, 1);
 
+    TIMEMORY_SETTINGS_MEMBER_ARG_IMPL(
+        double, snapshot_interval, TIMEMORY_SETTINGS_KEY("SNAPSHOT_INTERVAL"),
+        "Write intermediate output of the data collected so far every N seconds from a "
+        "background thread without stopping the components (0 disables)",
+        0.0, strvector_t({ "--timemory-snapshot-interval" }), 1);
+
+    TIMEMORY_SETTINGS_MEMBER_ARG_IMPL(
+        bool, snapshot_delta, TIMEMORY_SETTINGS_KEY("SNAPSHOT_DELTA"),
+        "Each snapshot only reports the data collected since the previous snapshot "
+        "(see also: TIMEMORY_SNAPSHOT_INTERVAL)",
+        false, strvector_t({ "--timemory-snapshot-delta" }), -1, 1);
+
     TIMEMORY_SETTINGS_MEMBER_ARG_IMPL(
         string_t, output_path, TIMEMORY_SETTINGS_KEY("OUTPUT_PATH"),
         "Explicitly specify the output folder for results", "timemory-output",
@@ -727,6 +739,13 @@ settings::initialize_parallel()
         " the master thread. Higher values tend to increase the finalization merge time",
         50);
 
+    TIMEMORY_SETTINGS_MEMBER_IMPL(
+        size_t, merge_threads, TIMEMORY_SETTINGS_KEY("MERGE_THREADS"),
+        "Number of threads used to merge the worker-thread call-graphs at finalization. "
+        "Values > 1 combine the call-graphs pairwise in a tree-reduction before merging "
+        "into the master thread",
+        1);
+
     TIMEMORY_SETTINGS_MEMBER_ARG_IMPL(
         bool, collapse_threads, TIMEMORY_SETTINGS_KEY("COLLAPSE_THREADS"),
         "Enable/disable combining thread-specific data", true,
@@ -770,6 +789,20 @@ settings::initialize_parallel()
         "TIMEMORY_MPI_INIT and TIMEMORY_MPI_THREAD)",
         mpi::use_mpi_thread_type(), strvector_t({ "--timemory-mpi-thread-type" }), 1);
 
+    TIMEMORY_SETTINGS_MEMBER_ARG_IMPL(
+        bool, mpi_binary_gather, TIMEMORY_SETTINGS_KEY("MPI_BINARY_GATHER"),
+        "Collect the results of all the ranks with a single MPI_Gatherv and, for "
+        "components which are trivially copyable, a compact binary encoding instead of "
+        "sending JSON from each rank to rank 0",
+        false, strvector_t({ "--timemory-mpi-binary-gather" }), -1, 1);
+
+    TIMEMORY_SETTINGS_MEMBER_ARG_IMPL(
+        bool, mpi_tree_reduction, TIMEMORY_SETTINGS_KEY("MPI_TREE_REDUCTION"),
+        "When collapsing processes, merge the results of the ranks pairwise in a "
+        "reduction tree (first within each node, then across nodes) instead of "
+        "collecting the results of every rank on rank 0",
+        false, strvector_t({ "--timemory-mpi-tree-reduction" }), -1, 1);
+
     TIMEMORY_SETTINGS_MEMBER_ARG_IMPL(
         bool, upcxx_init, TIMEMORY_SETTINGS_KEY("UPCXX_INIT"),
         "Enable/disable timemory calling upcxx::init() during certain "
@@ -959,6 +992,18 @@ settings::initialize_miscellaneous()
         "throttling",
         10000, strvector_t({ "--timemory-throttle-value" }), 1);
 
+    TIMEMORY_SETTINGS_MEMBER_ARG_IMPL(
+        double, throttle_decay, TIMEMORY_SETTINGS_KEY("THROTTLE_DECAY"),
+        "Weight (0, 1] of the most recent throttle_count laps in the exponentially "
+        "decayed average call time compared against throttle_value (1 == no history)",
+        0.5, strvector_t({ "--timemory-throttle-decay" }), 1);
+
+    TIMEMORY_SETTINGS_MEMBER_ARG_IMPL(
+        size_t, throttle_resample, TIMEMORY_SETTINGS_KEY("THROTTLE_RESAMPLE"),
+        "Number of skipped calls after which a throttled key is measured again so that "
+        "its throttling can be re-evaluated (0 == throttled keys stay throttled)",
+        0, strvector_t({ "--timemory-throttle-resample" }), 1);
+
     TIMEMORY_SETTINGS_MEMBER_ARG_IMPL(
         bool, enable_signal_handler, TIMEMORY_SETTINGS_KEY("ENABLE_SIGNAL_HANDLER"),
         "Enable signals in timemory_init", false,
@@ -988,6 +1033,31 @@ settings::initialize_miscellaneous()
         "Enable/disable stopping any markers still running during finalization", true,
         strvector_t({ "--timemory-stack-clearing" }), -1, 1);
 
+    TIMEMORY_SETTINGS_MEMBER_ARG_IMPL(
+        bool, overhead_compensation, TIMEMORY_SETTINGS_KEY("OVERHEAD_COMPENSATION"),
+        "Subtract the calibrated start/stop cost of the timing components for every "
+        "child measurement from the inclusive value of the parent during finalization",
+        false, strvector_t({ "--timemory-overhead-compensation" }), -1, 1);
+
+    TIMEMORY_SETTINGS_MEMBER_ARG_IMPL(
+        size_t, timeline_buffer_size, TIMEMORY_SETTINGS_KEY("TIMELINE_BUFFER_SIZE"),
+        "Number of timeline events kept in memory per thread and component. When "
+        "non-zero, timeline entries are recorded as fixed-size events and only inserted "
+        "into the call-graph during output. Zero inserts a call-graph node per entry",
+        0, strvector_t({ "--timemory-timeline-buffer-size" }), 1);
+
+    TIMEMORY_SETTINGS_MEMBER_ARG_IMPL(
+        string_t, timeline_spill_path, TIMEMORY_SETTINGS_KEY("TIMELINE_SPILL_PATH"),
+        "Folder where the oldest timeline events are written when the timeline buffer "
+        "is full. When empty, the oldest events are discarded",
+        "", strvector_t({ "--timemory-timeline-spill-path" }), 1);
+
+    TIMEMORY_SETTINGS_MEMBER_ARG_IMPL(
+        bool, timeline_trace, TIMEMORY_SETTINGS_KEY("TIMELINE_TRACE"),
+        "Stream the buffered timeline events (see TIMEMORY_TIMELINE_BUFFER_SIZE) to a "
+        "trace-event file for chrome://tracing or Perfetto while the application runs",
+        false, strvector_t({ "--timemory-timeline-trace" }), -1, 1);
+
     TIMEMORY_SETTINGS_MEMBER_IMPL(
         bool, banner, TIMEMORY_SETTINGS_KEY("BANNER"),
         "Notify about tim::manager creation and destruction",
@@ -1265,6 +1335,9 @@ TIMEMORY_SETTINGS_MEMBER_DEF(bool, diff_output, TIMEMORY_SETTINGS_KEY("DIFF_OUTP
 TIMEMORY_SETTINGS_MEMBER_DEF(bool, flamegraph_output,
                              TIMEMORY_SETTINGS_KEY("FLAMEGRAPH_OUTPUT"))
 TIMEMORY_SETTINGS_MEMBER_DEF(bool, ctest_notes, TIMEMORY_SETTINGS_KEY("CTEST_NOTES"))
+TIMEMORY_SETTINGS_MEMBER_DEF(double, snapshot_interval,
+                             TIMEMORY_SETTINGS_KEY("SNAPSHOT_INTERVAL"))
+TIMEMORY_SETTINGS_MEMBER_DEF(bool, snapshot_delta, TIMEMORY_SETTINGS_KEY("SNAPSHOT_DELTA"))
 TIMEMORY_SETTINGS_MEMBER_DEF(int, verbose, TIMEMORY_SETTINGS_KEY("VERBOSE"))
 TIMEMORY_SETTINGS_MEMBER_DEF(bool, debug, TIMEMORY_SETTINGS_KEY("DEBUG"))
 TIMEMORY_SETTINGS_MEMBER_DEF(bool, banner, TIMEMORY_SETTINGS_KEY("BANNER"))
@@ -1305,14 +1378,27 @@ TIMEMORY_SETTINGS_MEMBER_DEF(uint64_t, dart_count, TIMEMORY_SETTINGS_KEY("DART_C
 TIMEMORY_SETTINGS_MEMBER_DEF(bool, dart_label, TIMEMORY_SETTINGS_KEY("DART_LABEL"))
 TIMEMORY_SETTINGS_MEMBER_DEF(size_t, max_thread_bookmarks,
                              TIMEMORY_SETTINGS_KEY("MAX_THREAD_BOOKMARKS"))
+TIMEMORY_SETTINGS_MEMBER_DEF(size_t, merge_threads,
+                             TIMEMORY_SETTINGS_KEY("MERGE_THREADS"))
 TIMEMORY_SETTINGS_MEMBER_DEF(bool, cpu_affinity, TIMEMORY_SETTINGS_KEY("CPU_AFFINITY"))
 TIMEMORY_SETTINGS_MEMBER_DEF(bool, stack_clearing,
                              TIMEMORY_SETTINGS_KEY("STACK_CLEARING"))
+TIMEMORY_SETTINGS_MEMBER_DEF(bool, overhead_compensation,
+                             TIMEMORY_SETTINGS_KEY("OVERHEAD_COMPENSATION"))
+TIMEMORY_SETTINGS_MEMBER_DEF(size_t, timeline_buffer_size,
+                             TIMEMORY_SETTINGS_KEY("TIMELINE_BUFFER_SIZE"))
+TIMEMORY_SETTINGS_MEMBER_DEF(string_t, timeline_spill_path,
+                             TIMEMORY_SETTINGS_KEY("TIMELINE_SPILL_PATH"))
+TIMEMORY_SETTINGS_MEMBER_DEF(bool, timeline_trace, TIMEMORY_SETTINGS_KEY("TIMELINE_TRACE"))
 TIMEMORY_SETTINGS_MEMBER_DEF(bool, add_secondary, TIMEMORY_SETTINGS_KEY("ADD_SECONDARY"))
 TIMEMORY_SETTINGS_MEMBER_DEF(size_t, throttle_count,
                              TIMEMORY_SETTINGS_KEY("THROTTLE_COUNT"))
 TIMEMORY_SETTINGS_MEMBER_DEF(size_t, throttle_value,
                              TIMEMORY_SETTINGS_KEY("THROTTLE_VALUE"))
+TIMEMORY_SETTINGS_MEMBER_DEF(double, throttle_decay,
+                             TIMEMORY_SETTINGS_KEY("THROTTLE_DECAY"))
+TIMEMORY_SETTINGS_MEMBER_DEF(size_t, throttle_resample,
+                             TIMEMORY_SETTINGS_KEY("THROTTLE_RESAMPLE"))
 TIMEMORY_SETTINGS_MEMBER_DEF(string_t, global_components,
                              TIMEMORY_SETTINGS_KEY("GLOBAL_COMPONENTS"))
 TIMEMORY_SETTINGS_MEMBER_DEF(string_t, tuple_components,
@@ -1337,6 +1423,10 @@ TIMEMORY_SETTINGS_MEMBER_DEF(bool, mpi_finalize, TIMEMORY_SETTINGS_KEY("MPI_FINA
 TIMEMORY_SETTINGS_MEMBER_DEF(bool, mpi_thread, TIMEMORY_SETTINGS_KEY("MPI_THREAD"))
 TIMEMORY_SETTINGS_MEMBER_DEF(string_t, mpi_thread_type,
                              TIMEMORY_SETTINGS_KEY("MPI_THREAD_TYPE"))
+TIMEMORY_SETTINGS_MEMBER_DEF(bool, mpi_binary_gather,
+                             TIMEMORY_SETTINGS_KEY("MPI_BINARY_GATHER"))
+TIMEMORY_SETTINGS_MEMBER_DEF(bool, mpi_tree_reduction,
+                             TIMEMORY_SETTINGS_KEY("MPI_TREE_REDUCTION"))
 TIMEMORY_SETTINGS_MEMBER_DEF(bool, upcxx_init, TIMEMORY_SETTINGS_KEY("UPCXX_INIT"))
 TIMEMORY_SETTINGS_MEMBER_DEF(bool, upcxx_finalize,
                              TIMEMORY_SETTINGS_KEY("UPCXX_FINALIZE"))
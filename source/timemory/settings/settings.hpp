@@ -130,6 +130,8 @@ struct settings
     TIMEMORY_SETTINGS_MEMBER_DECL(bool, diff_output)
     TIMEMORY_SETTINGS_MEMBER_DECL(bool, flamegraph_output)
     TIMEMORY_SETTINGS_MEMBER_DECL(bool, ctest_notes)
+    TIMEMORY_SETTINGS_MEMBER_DECL(double, snapshot_interval)
+    TIMEMORY_SETTINGS_MEMBER_DECL(bool, snapshot_delta)
     TIMEMORY_SETTINGS_MEMBER_DECL(int, verbose)
     TIMEMORY_SETTINGS_MEMBER_DECL(bool, debug)
     TIMEMORY_SETTINGS_MEMBER_DECL(bool, banner)
@@ -158,11 +160,18 @@ struct settings
     TIMEMORY_SETTINGS_MEMBER_DECL(uint64_t, dart_count)
     TIMEMORY_SETTINGS_MEMBER_DECL(bool, dart_label)
     TIMEMORY_SETTINGS_MEMBER_DECL(size_t, max_thread_bookmarks)
+    TIMEMORY_SETTINGS_MEMBER_DECL(size_t, merge_threads)
     TIMEMORY_SETTINGS_MEMBER_DECL(bool, cpu_affinity)
     TIMEMORY_SETTINGS_MEMBER_DECL(bool, stack_clearing)
+    TIMEMORY_SETTINGS_MEMBER_DECL(bool, overhead_compensation)
+    TIMEMORY_SETTINGS_MEMBER_DECL(size_t, timeline_buffer_size)
+    TIMEMORY_SETTINGS_MEMBER_DECL(string_t, timeline_spill_path)
+    TIMEMORY_SETTINGS_MEMBER_DECL(bool, timeline_trace)
     TIMEMORY_SETTINGS_MEMBER_DECL(bool, add_secondary)
     TIMEMORY_SETTINGS_MEMBER_DECL(size_t, throttle_count)
     TIMEMORY_SETTINGS_MEMBER_DECL(size_t, throttle_value)
+    TIMEMORY_SETTINGS_MEMBER_DECL(double, throttle_decay)
+    TIMEMORY_SETTINGS_MEMBER_DECL(size_t, throttle_resample)
     TIMEMORY_SETTINGS_MEMBER_DECL(string_t, global_components)
     TIMEMORY_SETTINGS_MEMBER_DECL(string_t, tuple_components)
     TIMEMORY_SETTINGS_MEMBER_DECL(string_t, list_components)
@@ -177,6 +186,8 @@ struct settings
     TIMEMORY_SETTINGS_MEMBER_DECL(bool, mpi_finalize)
     TIMEMORY_SETTINGS_MEMBER_DECL(bool, mpi_thread)
     TIMEMORY_SETTINGS_MEMBER_DECL(string_t, mpi_thread_type)
+    TIMEMORY_SETTINGS_MEMBER_DECL(bool, mpi_binary_gather)
+    TIMEMORY_SETTINGS_MEMBER_DECL(bool, mpi_tree_reduction)
     TIMEMORY_SETTINGS_MEMBER_DECL(bool, upcxx_init)
     TIMEMORY_SETTINGS_MEMBER_DECL(bool, upcxx_finalize)
     TIMEMORY_SETTINGS_MEMBER_DECL(bool, papi_multiplexing)
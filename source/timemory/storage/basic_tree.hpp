@@ -30,6 +30,7 @@
 
 #include <iterator>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 namespace tim
@@ -72,11 +73,16 @@ struct basic_tree
     const auto& get_value() const { return m_value; }
     const auto& get_children() const { return m_children; }
 
+    /// return the hash identifying the node (with aliases resolved). Two trees are
+    /// equivalent when these are equal
+    hash_value_type get_hash() const
+    {
+        return get_hash_id(get_hash_aliases(), m_value.hash());
+    }
+
     friend bool operator==(const this_type& lhs, const this_type& rhs)
     {
-        auto _lhash = get_hash_id(get_hash_aliases(), lhs.m_value.hash());
-        auto _rhash = get_hash_id(get_hash_aliases(), rhs.m_value.hash());
-        return (_lhash == _rhash);
+        return (lhs.get_hash() == rhs.get_hash());
     }
 
     friend bool operator!=(const this_type& lhs, const this_type& rhs)
@@ -145,35 +151,41 @@ basic_tree<Tp>::operator+=(const this_type& rhs)
     }
     else
     {
-        std::set<size_t> found{};
-        auto nitr = std::min<size_t>(m_children.size(), rhs.m_children.size());
+        auto _nlhs  = m_children.size();
+        auto _nrhs  = rhs.m_children.size();
+        auto nitr   = std::min<size_t>(_nlhs, _nrhs);
+        auto _found = std::vector<bool>(_nrhs, false);
         // add identical entries
         for(size_t i = 0; i < nitr; ++i)
         {
             if((*m_children.at(i)) == (*rhs.m_children.at(i)))
             {
-                found.insert(i);
+                _found.at(i) = true;
                 (*m_children.at(i)) += (*rhs.m_children.at(i));
             }
         }
-        // add to first matching entry
-        for(size_t i = 0; i < rhs.m_children.size(); ++i)
+        // index the existing entries by hash so matching is linear in the number of
+        // children instead of quadratic
+        std::unordered_map<hash_value_type, std::vector<size_t>> _index{};
+        _index.reserve(_nlhs);
+        for(size_t j = 0; j < _nlhs; ++j)
+            _index[m_children.at(j)->get_hash()].emplace_back(j);
+        // add to matching entries
+        for(size_t i = 0; i < _nrhs; ++i)
         {
-            if(found.find(i) != found.end())
+            if(_found.at(i))
                 continue;
-            for(size_t j = 0; j < m_children.size(); ++j)
-            {
-                if((*m_children.at(j)) == (*rhs.m_children.at(i)))
-                {
-                    found.insert(i);
-                    (*m_children.at(j)) += (*rhs.m_children.at(i));
-                }
-            }
+            auto itr = _index.find(rhs.m_children.at(i)->get_hash());
+            if(itr == _index.end())
+                continue;
+            _found.at(i) = true;
+            for(auto j : itr->second)
+                (*m_children.at(j)) += (*rhs.m_children.at(i));
         }
         // append to end if not found anywhere
-        for(size_t i = 0; i < rhs.m_children.size(); ++i)
+        for(size_t i = 0; i < _nrhs; ++i)
         {
-            if(found.find(i) != found.end())
+            if(_found.at(i))
                 continue;
             m_children.insert(m_children.end(), rhs.m_children.at(i));
         }
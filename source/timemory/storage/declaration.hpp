@@ -43,16 +43,21 @@
 #include "timemory/storage/graph_data.hpp"
 #include "timemory/storage/macros.hpp"
 #include "timemory/storage/node.hpp"
+#include "timemory/storage/node_id_map.hpp"
+#include "timemory/storage/pointer_stack.hpp"
+#include "timemory/storage/timeline_buffer.hpp"
 #include "timemory/storage/types.hpp"
 #include "timemory/tpls/cereal/cereal.hpp"
 #include "timemory/utility/macros.hpp"
 #include "timemory/utility/singleton.hpp"
+#include "timemory/utility/trace_writer.hpp"
 #include "timemory/utility/types.hpp"
 #include "timemory/utility/utility.hpp"
 
 #include <atomic>
 #include <cstdint>
 #include <memory>
+#include <mutex>
 #include <tuple>
 #include <type_traits>
 #include <unordered_map>
@@ -130,9 +135,8 @@ public:
     using const_iterator = typename graph_type::const_iterator;
 
     template <typename Vp>
-    using secondary_data_t       = std::tuple<iterator, const std::string&, Vp>;
-    using iterator_hash_submap_t = uomap_t<int64_t, iterator>;
-    using iterator_hash_map_t    = uomap_t<int64_t, iterator_hash_submap_t>;
+    using secondary_data_t    = std::tuple<iterator, const std::string&, Vp>;
+    using iterator_hash_map_t = node_id_map<iterator>;
 
     friend class tim::manager;
     friend struct node::result<Type>;
@@ -144,6 +148,7 @@ public:
     friend struct operation::finalize::dmp_get<Type, has_data_v>;
     friend struct operation::finalize::print<Type, has_data_v>;
     friend struct operation::finalize::merge<Type, has_data_v>;
+    friend struct operation::finalize::snapshot<Type, has_data_v>;
 
 public:
     // static functions
@@ -227,7 +232,7 @@ public:
 
     iterator_hash_map_t get_node_ids() const { return m_node_ids; }
 
-    void stack_push(Type* obj) { m_stack.insert(obj); }
+    void stack_push(Type* obj) { m_stack.push(obj); }
     void stack_pop(Type* obj);
 
     void insert_init();
@@ -250,6 +255,35 @@ public:
     auto&       get_samples() { return m_samples; }
     const auto& get_samples() const { return m_samples; }
 
+    /// cost of one start and stop of the component, measured by the component itself
+    /// the first time it is requested. Only timing components with a scalar value are
+    /// calibrated, the accumulated value is zero for other components
+    static const Type& get_calibrated_overhead();
+
+    /// subtracts the calibrated overhead times the number of laps of all the
+    /// descendants from the accumulated value of each node. Invoked during
+    /// finalization when settings::overhead_compensation() is enabled
+    void compensate_overhead();
+
+    /// records a timeline entry as a fixed-size event instead of inserting a node into
+    /// the call-graph. Returns false when settings::timeline_buffer_size() is zero or
+    /// the value of the component cannot be stored in an event. The settings are read
+    /// on the first timeline entry after construction or \ref reset
+    bool timeline_push(scope::config scope_data, const Type* obj, uint64_t hash_id);
+
+    /// completes the event of \param obj, returns false if it is not a timeline event
+    bool timeline_pop(const Type* obj);
+
+    /// closes the trace-event file written when settings::timeline_trace() is enabled.
+    /// Invoked by the master thread after merging the data of the other threads, the
+    /// file is not reopened afterwards
+    static void close_timeline_trace();
+
+    /// inserts the completed timeline events into the call-graph. Invoked before the
+    /// data is retrieved or merged. Events which are still open are inserted by the
+    /// next invocation after they are popped
+    void materialize_timeline();
+
 protected:
     iterator insert_tree(uint64_t hash_id, const Type& obj, uint64_t hash_depth);
     iterator insert_timeline(uint64_t hash_id, const Type& obj, uint64_t hash_depth);
@@ -269,6 +303,93 @@ private:
     template <typename Archive>
     void do_serialize(Archive& ar);
 
+    template <typename Up>
+    using is_compensated_t =
+        std::integral_constant<bool,
+                               trait::is_timing_category<Up>::value &&
+                                   std::is_arithmetic<typename Up::value_type>::value>;
+
+    template <typename Up = Type>
+    static Up calibrate_overhead(enable_if_t<is_compensated_t<Up>::value, int> = 0);
+
+    template <typename Up = Type>
+    static Up calibrate_overhead(enable_if_t<!is_compensated_t<Up>::value, long> = 0);
+
+    template <typename Up = Type>
+    void compensate_overhead(enable_if_t<is_compensated_t<Up>::value, int>);
+
+    template <typename Up = Type>
+    void compensate_overhead(enable_if_t<!is_compensated_t<Up>::value, long>)
+    {}
+
+    template <typename Up>
+    using is_timeline_buffered_t = std::is_trivially_copyable<typename Up::value_type>;
+
+    using timeline_value_t = conditional_t<is_timeline_buffered_t<Type>::value,
+                                           typename Type::value_type, int64_t>;
+
+    /// fixed-size record of a timeline entry. The parent is the node which was current
+    /// in the call-graph and the sequence numbers order the events by their push
+    struct timeline_event
+    {
+        using node_pointer = decltype(std::declval<iterator>().node);
+
+        uint64_t                  sequence        = 0;
+        uint64_t                  parent_sequence = 0;
+        node_pointer              parent          = nullptr;
+        uint64_t                  hash            = 0;
+        int64_t                   depth           = 0;
+        int64_t                   tid             = 0;
+        int64_t                   begin           = 0;
+        int64_t                   end             = 0;
+        int64_t                   laps            = 0;
+        timeline_value_t          value           = {};
+        timeline_value_t          accum           = {};
+    };
+
+    using timeline_buffer_t = timeline_buffer<timeline_event>;
+    using timeline_open_t   = std::pair<const Type*, timeline_event>;
+
+    template <typename Up = Type>
+    bool timeline_push(scope::config, const Type*, uint64_t,
+                       enable_if_t<is_timeline_buffered_t<Up>::value, int>);
+
+    template <typename Up = Type>
+    bool timeline_push(scope::config, const Type*, uint64_t,
+                       enable_if_t<!is_timeline_buffered_t<Up>::value, long>)
+    {
+        return false;
+    }
+
+    template <typename Up = Type>
+    bool timeline_pop(const Type*, enable_if_t<is_timeline_buffered_t<Up>::value, int>);
+
+    template <typename Up = Type>
+    bool timeline_pop(const Type*, enable_if_t<!is_timeline_buffered_t<Up>::value, long>)
+    {
+        return false;
+    }
+
+    template <typename Up = Type>
+    void materialize_timeline(enable_if_t<is_timeline_buffered_t<Up>::value, int>);
+
+    template <typename Up = Type>
+    void materialize_timeline(enable_if_t<!is_timeline_buffered_t<Up>::value, long>)
+    {}
+
+    /// writes the events to the trace shared by all the threads
+    void write_timeline_trace(const timeline_event*, size_t);
+
+    struct timeline_trace_t
+    {
+        bool                          closed = false;
+        std::mutex                    mutex  = {};
+        std::shared_ptr<trace_writer> writer = {};
+    };
+
+    static timeline_trace_t&             timeline_trace_instance();
+    static std::shared_ptr<trace_writer> get_timeline_trace();
+
     void internal_print();
 
     graph_data_t&       _data();
@@ -279,12 +400,15 @@ private:
     }
 
 private:
-    uint64_t                   m_timeline_counter    = 1;
-    mutable graph_data_t*      m_graph_data_instance = nullptr;
-    iterator_hash_map_t        m_node_ids;
-    std::unordered_set<Type*>  m_stack;
-    std::shared_ptr<printer_t> m_printer;
-    sample_array_t             m_samples;
+    uint64_t                           m_timeline_counter    = 1;
+    uint64_t                           m_timeline_sequence   = 0;
+    mutable graph_data_t*              m_graph_data_instance = nullptr;
+    iterator_hash_map_t                m_node_ids;
+    pointer_stack<Type>                m_stack;
+    std::shared_ptr<printer_t>         m_printer;
+    sample_array_t                     m_samples;
+    std::unique_ptr<timeline_buffer_t> m_timeline;
+    std::vector<timeline_open_t>       m_timeline_open;
 };
 //
 //--------------------------------------------------------------------------------------//
@@ -296,22 +420,20 @@ storage<Type, true>::reset()
     // have the data graph erase all children of the head node
     if(m_graph_data_instance)
         m_graph_data_instance->reset();
-    // erase all the cached iterators except for m_node_ids[0][0]
-    for(auto& ditr : m_node_ids)
+    // the recorded timeline events refer to the erased nodes
+    m_timeline_open.clear();
+    m_timeline.reset();
+    // erase all the cached iterators except for the (0, 0) entry
+    auto* _head = m_node_ids.find(0, 0);
+    if(_head)
     {
-        auto _depth = ditr.first;
-        if(_depth != 0)
-        {
-            ditr.second.clear();
-        }
-        else
-        {
-            for(auto itr = ditr.second.begin(); itr != ditr.second.end(); ++itr)
-            {
-                if(itr->first != 0)
-                    ditr.second.erase(itr);
-            }
-        }
+        auto _itr = *_head;
+        m_node_ids.clear();
+        m_node_ids.insert(0, 0, _itr);
+    }
+    else
+    {
+        m_node_ids.clear();
     }
 }
 //
@@ -387,16 +509,16 @@ storage<Type, true>::append(const secondary_data_t<Vp>& _secondary)
     auto _depth = _itr->depth() + 1;
 
     // see if depth + hash entry exists already
-    auto _nitr = m_node_ids[_depth].find(_hash);
-    if(_nitr != m_node_ids[_depth].end())
+    auto* _nitr = m_node_ids.find(_depth, _hash);
+    if(_nitr)
     {
         // if so, then update
-        auto& _obj = _nitr->second->obj();
+        auto& _obj = (*_nitr)->obj();
         _obj += std::get<2>(_secondary);
-        _obj.set_laps(_nitr->second->obj().get_laps() + 1);
-        auto& _stats = _nitr->second->stats();
-        operation::add_statistics<Type>(_nitr->second->obj(), _stats);
-        return _nitr->second;
+        _obj.set_laps((*_nitr)->obj().get_laps() + 1);
+        auto& _stats = (*_nitr)->stats();
+        operation::add_statistics<Type>((*_nitr)->obj(), _stats);
+        return *_nitr;
     }
 
     // else, create a new entry
@@ -409,7 +531,7 @@ storage<Type, true>::append(const secondary_data_t<Vp>& _secondary)
     operation::add_statistics<Type>(_tmp, _stats);
     auto itr = _data().emplace_child(_itr, _node);
     itr->obj().set_iterator(itr);
-    m_node_ids[_depth][_hash] = itr;
+    m_node_ids.insert(_depth, _hash, itr);
     return itr;
 }
 //
@@ -438,11 +560,11 @@ storage<Type, true>::append(const secondary_data_t<Vp>& _secondary)
     auto _depth = _itr->depth() + 1;
 
     // see if depth + hash entry exists already
-    auto _nitr = m_node_ids[_depth].find(_hash);
-    if(_nitr != m_node_ids[_depth].end())
+    auto* _nitr = m_node_ids.find(_depth, _hash);
+    if(_nitr)
     {
-        _nitr->second->obj() += std::get<2>(_secondary);
-        return _nitr->second;
+        (*_nitr)->obj() += std::get<2>(_secondary);
+        return *_nitr;
     }
 
     // else, create a new entry
@@ -450,7 +572,7 @@ storage<Type, true>::append(const secondary_data_t<Vp>& _secondary)
     graph_node_t _node(_hash, _tmp, _depth, m_thread_idx);
     auto         itr = _data().emplace_child(_itr, _node);
     itr->obj().set_iterator(itr);
-    m_node_ids[_depth][_hash] = itr;
+    m_node_ids.insert(_depth, _hash, itr);
     return itr;
 }
 //
@@ -497,20 +619,20 @@ storage<Type, true>::insert_flat(uint64_t hash_id, const Type& obj, uint64_t has
         else
         {
             graph_node_t node(hash_id, obj, hash_depth, m_thread_idx);
-            auto         itr                = _data().emplace_child(_current, node);
-            m_node_ids[hash_depth][hash_id] = itr;
-            _current                        = itr;
+            auto         itr = _data().emplace_child(_current, node);
+            m_node_ids.insert(hash_depth, hash_id, itr);
+            _current = itr;
             return itr;
         }
     }
 
-    auto _existing = m_node_ids[hash_depth].find(hash_id);
-    if(_existing != m_node_ids[hash_depth].end())
-        return m_node_ids[hash_depth].find(hash_id)->second;
+    auto* _existing = m_node_ids.find(hash_depth, hash_id);
+    if(_existing)
+        return *_existing;
 
     graph_node_t node(hash_id, obj, hash_depth, m_thread_idx);
-    auto         itr                = _data().emplace_child(_current, node);
-    m_node_ids[hash_depth][hash_id] = itr;
+    auto         itr = _data().emplace_child(_current, node);
+    m_node_ids.insert(hash_depth, hash_id, itr);
     return itr;
 }
 //
@@ -521,7 +643,6 @@ typename storage<Type, true>::iterator
 storage<Type, true>::insert_hierarchy(uint64_t hash_id, const Type& obj,
                                       uint64_t hash_depth, bool has_head)
 {
-    using id_hash_map_t = typename iterator_hash_map_t::mapped_type;
     // PRINT_HERE("%s", "");
 
     auto& m_data = m_graph_data_instance;
@@ -531,8 +652,8 @@ storage<Type, true>::insert_hierarchy(uint64_t hash_id, const Type& obj,
     if(!has_head || (m_is_master && m_node_ids.empty()))
     {
         graph_node_t node(hash_id, obj, hash_depth, tid);
-        auto         itr                = m_data->append_child(node);
-        m_node_ids[hash_depth][hash_id] = itr;
+        auto         itr = m_data->append_child(node);
+        m_node_ids.insert(hash_depth, hash_id, itr);
         return itr;
     }
 
@@ -542,11 +663,9 @@ storage<Type, true>::insert_hierarchy(uint64_t hash_id, const Type& obj,
         return (m_data->current() = itr);
     };
 
-    if(m_node_ids[hash_depth].find(hash_id) != m_node_ids[hash_depth].end() &&
-       m_node_ids[hash_depth].find(hash_id)->second->depth() == m_data->depth())
-    {
-        return _update(m_node_ids[hash_depth].find(hash_id)->second);
-    }
+    auto* _existing = m_node_ids.find(hash_depth, hash_id);
+    if(_existing && (*_existing)->depth() == m_data->depth())
+        return _update(*_existing);
 
     using sibling_itr = typename graph_t::sibling_iterator;
     graph_node_t node(hash_id, obj, m_data->depth(), tid);
@@ -555,13 +674,7 @@ storage<Type, true>::insert_hierarchy(uint64_t hash_id, const Type& obj,
     auto _insert_child = [&]() {
         node.depth() = hash_depth;
         auto itr     = m_data->append_child(node);
-        auto ditr    = m_node_ids.find(hash_depth);
-        if(ditr == m_node_ids.end())
-            m_node_ids.insert({ hash_depth, id_hash_map_t{} });
-        auto hitr = m_node_ids.at(hash_depth).find(hash_id);
-        if(hitr == m_node_ids.at(hash_depth).end())
-            m_node_ids.at(hash_depth).insert({ hash_id, iterator{} });
-        m_node_ids.at(hash_depth).at(hash_id) = itr;
+        m_node_ids.insert(hash_depth, hash_id, itr);
         return itr;
     };
 
@@ -692,6 +805,7 @@ public:
     friend struct operation::finalize::dmp_get<Type, has_data_v>;
     friend struct operation::finalize::print<Type, has_data_v>;
     friend struct operation::finalize::merge<Type, has_data_v>;
+    friend struct operation::finalize::snapshot<Type, has_data_v>;
 
 public:
     static pointer instance();
@@ -737,7 +851,7 @@ public:
     void serialize(Archive&, const unsigned int)
     {}
 
-    void stack_push(Type* obj) { m_stack.insert(obj); }
+    void stack_push(Type* obj) { m_stack.push(obj); }
     void stack_pop(Type* obj);
 
     TIMEMORY_NODISCARD std::shared_ptr<printer_t> get_printer() const
@@ -756,7 +870,7 @@ private:
     {}
 
 private:
-    std::unordered_set<Type*>  m_stack;
+    pointer_stack<Type>        m_stack;
     std::shared_ptr<printer_t> m_printer;
 };
 //
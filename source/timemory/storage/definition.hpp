@@ -42,7 +42,11 @@
 #include "timemory/storage/macros.hpp"
 #include "timemory/storage/types.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <functional>
+#include <limits>
 #include <memory>
 #include <utility>
 
@@ -176,7 +180,10 @@ TIMEMORY_STORAGE_LINKAGE void
 storage::free_shared_manager()
 {
     if(m_manager)
+    {
         m_manager->remove_finalizer(m_label);
+        m_manager->remove_snapshot(m_label);
+    }
 }
 //
 #endif
@@ -332,28 +339,6 @@ storage<Type, true>::storage()
 
     component::state<Type>::has_storage() = true;
 
-    static std::atomic<int32_t> _skip_once(0);
-    if(_skip_once++ > 0)
-    {
-        // make sure all worker instances have a copy of the hash id and aliases
-        auto _master = singleton_t::master_instance();
-        if(_master)
-        {
-            graph_hash_map_t   _hash_ids     = *_master->get_hash_ids();
-            graph_hash_alias_t _hash_aliases = *_master->get_hash_aliases();
-            for(const auto& itr : _hash_ids)
-            {
-                if(m_hash_ids->find(itr.first) == m_hash_ids->end())
-                    m_hash_ids->insert({ itr.first, itr.second });
-            }
-            for(const auto& itr : _hash_aliases)
-            {
-                if(m_hash_aliases->find(itr.first) == m_hash_aliases->end())
-                    m_hash_aliases->insert({ itr.first, itr.second });
-            }
-        }
-    }
-
     get_shared_manager();
     // m_printer = std::make_shared<printer_t>(Type::get_label(), this);
 }
@@ -444,14 +429,17 @@ storage<Type, true>::stack_clear()
 {
     if(!m_stack.empty() && m_settings->get_stack_clearing())
     {
-        std::unordered_set<Type*> _stack = m_stack;
-        for(auto& itr : _stack)
+        // copy because pop_node removes the entry from m_stack. Iterate from the top
+        // of the stack so that the nodes are popped in the reverse order of the push
+        auto _stack = m_stack;
+        for(auto itr = _stack.end(); itr != _stack.begin();)
         {
+            --itr;
             operation::generic_operator<Type, operation::start<Type>, TIMEMORY_API>{
-                *itr
+                **itr
             };
             operation::generic_operator<Type, operation::pop_node<Type>, TIMEMORY_API>{
-                *itr
+                **itr
             };
         }
     }
@@ -631,9 +619,7 @@ template <typename Type>
 void
 storage<Type, true>::stack_pop(Type* obj)
 {
-    auto itr = m_stack.find(obj);
-    if(itr != m_stack.end())
-        m_stack.erase(itr);
+    m_stack.pop(obj);
 }
 //
 //--------------------------------------------------------------------------------------//
@@ -782,7 +768,7 @@ storage<Type, true>::_data()
         }
 
         if(m_node_ids.empty())
-            m_node_ids[0][0] = m_graph_data_instance->current();
+            m_node_ids.insert(0, 0, m_graph_data_instance->current());
     }
 
     m_initialized = true;
@@ -803,7 +789,20 @@ storage<Type, true>::merge()
         return;
 
     for(auto& itr : m_children)
-        merge(itr);
+        itr->materialize_timeline();
+
+    auto _nthreads = m_settings->get_merge_threads();
+    if(_nthreads > 1 && m_children.size() > 2)
+    {
+        operation::finalize::merge<Type, true>(
+            *this, std::vector<this_type*>(m_children.begin(), m_children.end()),
+            _nthreads);
+    }
+    else
+    {
+        for(auto& itr : m_children)
+            merge(itr);
+    }
 
     // create lock
     auto_lock_t l(singleton_t::get_mutex(), std::defer_lock);
@@ -813,7 +812,10 @@ storage<Type, true>::merge()
     for(auto& itr : m_children)
     {
         if(itr != this)
+        {
             itr->data().clear();
+            itr->m_timeline_open.clear();
+        }
     }
 
     stack_clear();
@@ -832,9 +834,368 @@ storage<Type, true>::merge(this_type* itr)
 //--------------------------------------------------------------------------------------//
 //
 template <typename Type>
+const Type&
+storage<Type, true>::get_calibrated_overhead()
+{
+    static Type _instance = calibrate_overhead();
+    return _instance;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+template <typename Up>
+Up
+storage<Type, true>::calibrate_overhead(enable_if_t<is_compensated_t<Up>::value, int>)
+{
+    using value_type        = typename Up::value_type;
+    constexpr int64_t nlaps = 1000;
+    constexpr int64_t ntry  = 5;
+
+    // the minimum of several trials excludes the interruptions
+    value_type _cost = std::numeric_limits<value_type>::max();
+    for(int64_t i = 0; i < ntry; ++i)
+    {
+        Up _outer{};
+        Up _inner{};
+        _outer.start();
+        for(int64_t j = 0; j < nlaps; ++j)
+        {
+            _inner.start();
+            _inner.stop();
+        }
+        _outer.stop();
+        _cost = std::min<value_type>(_cost, _outer.get_accum() / nlaps);
+    }
+
+    Up _obj{};
+    _obj.set_value(_cost);
+    _obj.set_accum(_cost);
+    _obj.set_laps(1);
+    return _obj;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+template <typename Up>
+Up
+storage<Type, true>::calibrate_overhead(enable_if_t<!is_compensated_t<Up>::value, long>)
+{
+    return Up{};
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+void
+storage<Type, true>::compensate_overhead()
+{
+    compensate_overhead<Type>(0);
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+template <typename Up>
+void
+storage<Type, true>::compensate_overhead(enable_if_t<is_compensated_t<Up>::value, int>)
+{
+    using value_type       = typename Up::value_type;
+    using sibling_iterator = typename graph_type::sibling_iterator;
+
+    if(!m_graph_data_instance)
+        return;
+
+    auto _cost = get_calibrated_overhead().get_accum();
+    if(!(_cost > value_type{}))
+        return;
+
+    auto& _graph = _data().graph();
+    // returns the number of laps of the node and all of its descendants
+    std::function<int64_t(sibling_iterator)> _compensate;
+    _compensate = [&](sibling_iterator itr) -> int64_t {
+        int64_t _laps = 0;
+        for(sibling_iterator citr = _graph.begin(itr); citr != _graph.end(itr); ++citr)
+            _laps += _compensate(citr);
+        auto& _obj   = itr->obj();
+        auto  _accum = _obj.get_accum();
+        auto  _diff  = _cost * static_cast<value_type>(_laps);
+        _obj.set_accum((_diff < _accum) ? (_accum - _diff) : value_type{});
+        return _laps + _obj.get_laps();
+    };
+
+    for(sibling_iterator itr = _graph.begin(); itr != _graph.end(); ++itr)
+        _compensate(itr);
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+bool
+storage<Type, true>::timeline_push(scope::config scope_data, const Type* obj,
+                                   uint64_t hash_id)
+{
+    return timeline_push<Type>(scope_data, obj, hash_id, 0);
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+template <typename Up>
+bool
+storage<Type, true>::timeline_push(scope::config scope_data, const Type* obj,
+                                   uint64_t hash_id,
+                                   enable_if_t<is_timeline_buffered_t<Up>::value, int>)
+{
+    using force_tree_t = trait::tree_storage<Type>;
+    using force_flat_t = trait::flat_storage<Type>;
+    using force_time_t = trait::timeline_storage<Type>;
+
+    if(!m_timeline)
+    {
+        auto _size = m_settings->get_timeline_buffer_size();
+        if(_size == 0)
+            return false;
+        m_timeline = std::make_unique<timeline_buffer_t>(
+            _size, m_settings->get_timeline_spill_path());
+        if(m_settings->get_timeline_trace() && m_settings->get_file_output())
+        {
+            m_timeline->set_observer([this](const timeline_event* _data, size_t _n) {
+                write_timeline_trace(_data, _n);
+            });
+        }
+    }
+
+    insert_init();
+
+    // same as insert: bookmark the location of the master thread
+    if(!m_is_master && _data().at_sea_level() &&
+       _data().dummy_count() < m_settings->get_max_thread_bookmarks())
+        _data().add_dummy();
+
+    bool           _flat  = scope_data.is_flat() || force_flat_t::value;
+    auto           _depth = _data().depth();
+    timeline_event _event{};
+    _event.sequence = ++m_timeline_sequence;
+    _event.parent   = (_flat) ? _data().head().node : _data().current().node;
+    _event.hash     = hash_id;
+    _event.tid      = m_thread_idx;
+
+    // nest within the innermost timeline event started at the same call-graph node
+    if(!_flat)
+    {
+        for(auto itr = m_timeline_open.rbegin(); itr != m_timeline_open.rend(); ++itr)
+        {
+            if(itr->second.parent == _event.parent)
+            {
+                _event.parent_sequence = itr->second.sequence;
+                _depth                 = itr->second.depth;
+                break;
+            }
+        }
+    }
+
+    _event.depth = scope_data.compute_depth<force_tree_t, force_flat_t, force_time_t>(
+        _depth);
+    _event.begin = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                       .count();
+    m_timeline_open.emplace_back(obj, _event);
+    return true;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+bool
+storage<Type, true>::timeline_pop(const Type* obj)
+{
+    return timeline_pop<Type>(obj, 0);
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+template <typename Up>
+bool
+storage<Type, true>::timeline_pop(const Type* obj,
+                                  enable_if_t<is_timeline_buffered_t<Up>::value, int>)
+{
+    for(auto itr = m_timeline_open.rbegin(); itr != m_timeline_open.rend(); ++itr)
+    {
+        if(itr->first != obj)
+            continue;
+        auto& _event = itr->second;
+        _event.end   = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now().time_since_epoch())
+                         .count();
+        _event.laps  = obj->get_laps();
+        _event.value = obj->get_value();
+        _event.accum = obj->get_accum();
+        m_timeline->push_back(_event);
+        m_timeline_open.erase(std::next(itr).base());
+        return true;
+    }
+    return false;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+void
+storage<Type, true>::materialize_timeline()
+{
+    materialize_timeline<Type>(0);
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+template <typename Up>
+void
+storage<Type, true>::materialize_timeline(
+    enable_if_t<is_timeline_buffered_t<Up>::value, int>)
+{
+    if(!m_timeline || m_timeline->empty())
+        return;
+
+    // the discarded events have been written to the trace when it is observed
+    if(m_timeline->dropped() > 0 && !m_timeline->has_observer() &&
+       m_settings->get_verbose() >= 0)
+    {
+        fprintf(stderr,
+                "[%s]> %lu timeline events were discarded because the timeline buffer "
+                "was full. Increase %s or set %s\n",
+                m_label.c_str(), (unsigned long) m_timeline->dropped(),
+                TIMEMORY_SETTINGS_KEY("TIMELINE_BUFFER_SIZE"),
+                TIMEMORY_SETTINGS_KEY("TIMELINE_SPILL_PATH"));
+    }
+
+    std::vector<timeline_event> _events{};
+    _events.reserve(m_timeline->size());
+    m_timeline->for_each([&_events](const timeline_event& _v) { _events.emplace_back(_v); });
+    m_timeline->clear();
+
+    // events are recorded when they are popped, insert them in the order of the push
+    std::sort(_events.begin(), _events.end(),
+              [](const timeline_event& _lhs, const timeline_event& _rhs) {
+                  return _lhs.sequence < _rhs.sequence;
+              });
+
+    // the inserted ancestors of the current event
+    std::vector<std::pair<uint64_t, iterator>> _ancestors{};
+    for(const auto& itr : _events)
+    {
+        while(!_ancestors.empty() && _ancestors.back().first != itr.parent_sequence)
+            _ancestors.pop_back();
+
+        iterator _parent =
+            (_ancestors.empty()) ? iterator{ itr.parent } : _ancestors.back().second;
+
+        // same as scope::config::compute_hash for a timeline entry
+        auto _hash = itr.hash ^ static_cast<uint64_t>(itr.depth) ^ m_timeline_counter++;
+        add_hash_id(itr.hash, _hash);
+
+        Type _obj{};
+        _obj.set_value(itr.value);
+        _obj.set_accum(itr.accum);
+        _obj.set_laps(itr.laps);
+
+        graph_node_t _node(_hash, _obj, itr.depth, itr.tid);
+        auto         _itr = _data().emplace_child(_parent, _node);
+        operation::add_statistics<Type>(_obj, _itr->stats());
+        m_node_ids.insert(itr.depth, _hash, _itr);
+        _ancestors.emplace_back(itr.sequence, _itr);
+    }
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+void
+storage<Type, true>::write_timeline_trace(const timeline_event* _data, size_t _n)
+{
+    auto _trace = get_timeline_trace();
+    if(!_trace || !_trace->is_open())
+        return;
+
+    constexpr size_t _max = trace_writer::buffer_size;
+    auto             _pid = process::get_id();
+    std::string      _buffer{};
+    _buffer.reserve(std::min<size_t>(_n * 96, _max));
+    std::unordered_map<uint64_t, std::string> _names{};
+    for(size_t i = 0; i < _n; ++i)
+    {
+        const auto& itr   = _data[i];
+        auto        _name = _names.find(itr.hash);
+        if(_name == _names.end())
+            _name = _names.emplace(itr.hash, get_prefix(itr.hash)).first;
+        // steady-clock nanoseconds to microseconds
+        trace_writer::complete(_buffer, _name->second, _pid, itr.tid,
+                               itr.begin * 1.0e-3, (itr.end - itr.begin) * 1.0e-3);
+        if(_buffer.size() >= trace_writer::buffer_size)
+            _trace->write(_buffer);
+    }
+    _trace->write(_buffer);
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+typename storage<Type, true>::timeline_trace_t&
+storage<Type, true>::timeline_trace_instance()
+{
+    static timeline_trace_t _instance{};
+    return _instance;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+std::shared_ptr<trace_writer>
+storage<Type, true>::get_timeline_trace()
+{
+    auto&                       _instance = timeline_trace_instance();
+    std::lock_guard<std::mutex> _lk{ _instance.mutex };
+    if(!_instance.writer && !_instance.closed)
+    {
+        auto _fname = settings::compose_output_filename(
+            Type::get_label() + std::string(".timeline"), ".json");
+        _instance.writer = std::make_shared<trace_writer>(_fname);
+    }
+    return _instance.writer;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+void
+storage<Type, true>::close_timeline_trace()
+{
+    auto&                       _instance = timeline_trace_instance();
+    std::lock_guard<std::mutex> _lk{ _instance.mutex };
+    if(!_instance.writer)
+        return;
+    if(_instance.writer->is_open())
+    {
+        manager::instance()->add_json_output(Type::get_label(),
+                                             _instance.writer->filename());
+        printf("[%s]|%i> Outputting '%s'...\n", Type::get_label().c_str(),
+               dmp::rank(), _instance.writer->filename().c_str());
+    }
+    _instance.writer->close();
+    _instance.writer.reset();
+    _instance.closed = true;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
 typename storage<Type, true>::result_array_t
 storage<Type, true>::get()
 {
+    materialize_timeline();
     result_array_t _ret;
     operation::finalize::get<Type, true>{ *this }(_ret);
     return _ret;
@@ -847,6 +1208,7 @@ template <typename Tp>
 Tp&
 storage<Type, true>::get(Tp& _ret)
 {
+    materialize_timeline();
     return operation::finalize::get<Type, true>{ *this }(_ret);
 }
 //
@@ -924,6 +1286,8 @@ storage<Type, true>::internal_print()
     if(!m_initialized && !m_finalized)
         return;
 
+    materialize_timeline();
+
     if(!singleton_t::is_master(this))
     {
         if(singleton_t::master_instance())
@@ -935,6 +1299,9 @@ storage<Type, true>::internal_print()
         merge();
         finalize();
 
+        // all the timeline events have been written by the merge
+        close_timeline_trace();
+
         if(!trait::runtime_enabled<Type>::get())
         {
             instance_count().store(0);
@@ -955,6 +1322,9 @@ storage<Type, true>::internal_print()
             return;
         }
 
+        if(m_settings->get_overhead_compensation())
+            compensate_overhead();
+
         // generate output
         if(m_settings->get_auto_output())
         {
@@ -1070,6 +1440,15 @@ storage<Type, true>::get_shared_manager()
         }
         m_manager->add_finalizer(demangle<Type>(), std::move(_cleanup),
                                  std::move(_finalize), _is_master);
+
+        // the singleton does not know this is the master instance until after it is
+        // constructed
+        if(m_is_master)
+        {
+            m_manager->add_snapshot(demangle<Type>(), [this](int64_t _idx) {
+                operation::finalize::snapshot<Type, true>{ *this }(_idx);
+            });
+        }
     }
 }
 //
@@ -1109,7 +1488,7 @@ storage<Type, false>::stack_clear()
 {
     if(!m_stack.empty() && m_settings->get_stack_clearing())
     {
-        std::unordered_set<Type*> _stack = m_stack;
+        auto _stack = m_stack;
         for(auto& itr : _stack)
             operation::stop<Type>{ *itr };
     }
@@ -1186,11 +1565,7 @@ template <typename Type>
 void
 storage<Type, false>::stack_pop(Type* obj)
 {
-    auto itr = m_stack.find(obj);
-    if(itr != m_stack.end())
-    {
-        m_stack.erase(itr);
-    }
+    m_stack.pop(obj);
 }
 //
 //--------------------------------------------------------------------------------------//
@@ -41,6 +41,7 @@
 #include <queue>
 #include <set>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -104,16 +105,18 @@ tgraph_node<T>::tgraph_node(T&& val) noexcept
 {}
 
 //======================================================================================//
-//  graph allocator that counts the size of the allocation (unused)
-//
-//
-#if defined(TIMEMORY_GRAPH_ALLOCATOR)
-
+/// \class tim::graph_allocator
+/// \brief Slab allocator for the nodes of a \ref tim::graph. Nodes are carved out of
+/// contiguous chunks (which double in size up to a cap) instead of being allocated
+/// individually so that graphs w/ hundreds of thousands of nodes do not fragment the
+/// heap and neighboring nodes are likely to share cache lines. Deallocated nodes are
+/// recycled through an intrusive free-list and \ref release returns every chunk at
+/// once. Each instance owns its chunks: copies start out empty and the graph instance
+/// which owns the allocator (one per thread in storage) is the only user.
 template <typename Tp>
-class graph_allocator : public std::allocator<Tp>
+class graph_allocator
 {
 public:
-    // The following will be the same for virtually all allocators.
     using value_type      = Tp;
     using pointer         = Tp*;
     using reference       = Tp&;
@@ -121,209 +124,245 @@ public:
     using const_reference = const Tp&;
     using size_type       = size_t;
     using difference_type = ptrdiff_t;
-    using boolvec_t       = std::deque<bool>;
-    using voidvec_t       = std::vector<void*>;
-    using sizevec_t       = std::vector<uint16_t>;
-    using base_type       = std::allocator<Tp>;
 
-public:
-    // constructors and destructors
-    graph_allocator()                           = default;
-    graph_allocator(const graph_allocator&)     = delete;
-    graph_allocator(graph_allocator&&) noexcept = default;
-    ~graph_allocator()
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap            = std::true_type;
+    using is_always_equal                        = std::false_type;
+
+    template <typename U>
+    struct rebind
     {
-        for(auto& itr : m_allocations)
-            free(itr);
-    }
+        using other = graph_allocator<U>;
+    };
 
-public:
-    // operators
-    graph_allocator& operator=(const graph_allocator&) = delete;
-    graph_allocator& operator==(graph_allocator&&)     = delete;
-    bool operator!=(const graph_allocator& other) const { return !(*this == other); }
-    bool operator==(const graph_allocator&) const { return true; }
+    static constexpr size_t min_chunk_size = 32;
+    static constexpr size_t max_chunk_size = 8192;
+
+private:
+    union slot_type
+    {
+        slot_type* next;
+        alignas(Tp) char data[sizeof(Tp)];
+    };
+
+    struct chunk_type
+    {
+        slot_type* data = nullptr;
+        size_t     size = 0;
+    };
 
 public:
-    Tp*       address(Tp& r) const { return &r; }
-    const Tp* address(const Tp& s) const { return &s; }
+    graph_allocator() = default;
+    ~graph_allocator() { release(); }
+
+    // copies do not share chunks
+    graph_allocator(const graph_allocator&) noexcept {}
+    graph_allocator& operator=(const graph_allocator&) noexcept { return *this; }
 
-    size_t max_size() const
+    graph_allocator(graph_allocator&& rhs) noexcept { swap(rhs); }
+    graph_allocator& operator=(graph_allocator&& rhs) noexcept
     {
-        // avoid signed/unsigned warnings independent of size_t definition
-        return (static_cast<size_t>(0) - static_cast<size_t>(1)) / sizeof(Tp);
+        if(this != &rhs)
+        {
+            release();
+            swap(rhs);
+        }
+        return *this;
     }
 
-    // The following must be the same for all allocators.
     template <typename U>
-    struct rebind
-    {
-        typedef graph_allocator<U> other;
-    };
+    graph_allocator(const graph_allocator<U>&) noexcept  // NOLINT
+    {}
 
-    // using base_type::construct;
-    // using base_type::destroy;
+    bool operator==(const graph_allocator& rhs) const { return (this == &rhs); }
+    bool operator!=(const graph_allocator& rhs) const { return (this != &rhs); }
 
-    void construct(Tp* const p, const Tp& val) const { ::new((void*) p) Tp(val); }
+public:
+    static Tp*       address(Tp& r) { return &r; }
+    static const Tp* address(const Tp& s) { return &s; }
+
+    static size_t max_size()
+    {
+        return (static_cast<size_t>(0) - static_cast<size_t>(1)) / sizeof(Tp);
+    }
 
     template <typename... ArgsT>
-    void construct(Tp* const p, ArgsT&&... args) const
+    static void construct(Tp* const p, ArgsT&&... args)
     {
         ::new((void*) p) Tp(std::forward<ArgsT>(args)...);
     }
 
-    void destroy(Tp* const p) const { p->~Tp(); }
+    static void destroy(Tp* const p) { p->~Tp(); }
 
-    Tp* allocate(const size_t n) const
+    Tp* allocate(const size_t n, const void* = nullptr)
     {
         if(n == 0)
             return nullptr;
 
         // integer overflow check that throws std::length_error in case of overflow
         if(n > max_size())
-        {
-            throw std::length_error(
-                "graph_allocator<Tp>::allocate() - Integer overflow.");
-        }
-
-        auto _check_page_entry = [&](size_t i, size_t& j) -> Tp* {
-            if(m_offset_avail[i][j])
-            {
-                bool _block = true;
-                for(size_t k = 1; k < n; ++k)
-                    if(!m_offset_avail[i][j + k])
-                    {
-                        _block = false;
-                        j += k + 1;
-                        break;
-                    }
-                if(_block)
-                {
-                    Tp* ptr = ((Tp*) m_pages[i]) + j;
-                    for(size_t k = 0; k < n; ++k)
-                        m_offset_avail[i][j + k] = false;
-                    m_offset_empty[i] -= n;
-                    return ptr;
-                }
-            }
-            return nullptr;
-        };
+            throw std::length_error("graph_allocator<Tp>::allocate() - Integer overflow.");
 
-        if(!m_next_addr)
-            add_pages(1);
+        // multi-element requests are never made by tim::graph
+        if(n > 1)
+            return static_cast<Tp*>(::operator new(n * sizeof(Tp)));
 
-        if(m_next_offset < m_alloc_per_page && m_offset_empty[m_next_page] >= n)
+        if(m_free)
         {
-            for(size_t j = m_next_offset; j < m_offset_avail[m_next_page].size(); ++j)
-            {
-                auto _ptr = _check_page_entry(m_next_page, j);
-                if(_ptr)
-                {
-                    m_next_offset += n;
-                    return _ptr;
-                }
-            }
+            auto* _slot = m_free;
+            m_free      = m_free->next;
+            return reinterpret_cast<Tp*>(_slot);
         }
 
-        // Mallocator wraps malloc().
-        for(size_t i = 0; i < m_pages.size(); ++i)
-        {
-            if(m_offset_empty[i] >= n)
-            {
-                for(size_t j = 0; j < m_offset_avail[i].size(); ++j)
-                {
-                    auto _ptr = _check_page_entry(i, j);
-                    if(_ptr)
-                        return _ptr;
-                }
-            }
-        }
+        if(m_next == m_last)
+            add_chunk(0);
 
-        add_pages(1);
-        for(size_t k = 0; k < n; ++k)
-            m_offset_avail[m_next_page][m_next_offset + k] = false;
-        m_offset_empty[m_next_page] -= n;
-        m_next_offset += n;
-        return static_cast<Tp*>(m_next_addr);
+        return reinterpret_cast<Tp*>(m_next++);
     }
 
-    void deallocate(Tp* const ptr, const size_t n) const
+    void deallocate(Tp* const ptr, const size_t n)
     {
-        for(size_t j = 0; j < n; ++j)
+        if(ptr == nullptr || n == 0)
+            return;
+
+        if(n > 1)
         {
-            char* _ptr = (char*) ptr + j;
-            for(size_t i = 0; i < m_pages.size(); ++i)
-            {
-                auto itr  = m_pages[i];
-                auto dist = std::distance((char*) itr, _ptr);
-                if(dist >= 0 && dist < units::get_page_size())
-                {
-                    m_offset_avail[i][dist] = true;
-                    m_offset_empty[i] += 1;
-                }
-            }
+            ::operator delete(ptr);
+            return;
         }
+
+        auto* _slot = reinterpret_cast<slot_type*>(ptr);
+        _slot->next = m_free;
+        m_free      = _slot;
     }
 
-    // same for all allocators that ignore hints.
-    // template <typename U = Tp>
-    Tp* allocate(const size_t n, const void* /* const hint */) const
+    /// ensure that at least n more nodes can be allocated w/o allocating a chunk
+    void reserve(const size_t n)
     {
-        return allocate(n);
+        auto _avail = static_cast<size_t>(m_last - m_next);
+        if(n > _avail)
+            add_chunk(n - _avail);
     }
 
-    size_t alloc_bytes() const { return units::get_page_size() * m_pages.size(); }
-
-    void reserve(const size_t n)
+    /// frees all the chunks. Any node which has not been destroyed is leaked.
+    void release()
     {
-        auto npages = n / m_alloc_per_page + 1;
-        add_pages(npages);
+        for(auto& itr : m_chunks)
+            delete[] itr.data;
+        m_chunks.clear();
+        m_free = nullptr;
+        m_next = nullptr;
+        m_last = nullptr;
     }
 
-private:
-    void add_pages(int npages = 1) const
+    /// take ownership of all the chunks in another allocator, which is left empty.
+    /// Used when nodes are spliced from one graph into another.
+    void absorb(graph_allocator& rhs)
     {
-        auto  nbytes = npages * units::get_page_size();
-        void* _space = malloc(nbytes);
-        m_allocations.push_back(_space);
+        if(this == &rhs || rhs.m_chunks.empty())
+            return;
 
-        // throw std::bad_alloc in the case of memory allocation failure.
-        if(_space == nullptr)
+        // the remainder of the bump-pointer region in rhs is not recycled
+        for(auto& itr : rhs.m_chunks)
+            m_chunks.emplace_back(itr);
+        if(rhs.m_free)
         {
-            std::cerr << "Allocation of type " << typeid(Tp).name() << " of size "
-                      << nbytes << " failed" << std::endl;
-            throw std::bad_alloc();
+            auto* _tail = rhs.m_free;
+            while(_tail->next)
+                _tail = _tail->next;
+            _tail->next = m_free;
+            m_free      = rhs.m_free;
         }
+        rhs.m_chunks.clear();
+        rhs.m_free = nullptr;
+        rhs.m_next = nullptr;
+        rhs.m_last = nullptr;
+    }
 
-        auto _num_pages = m_pages.size();
-        m_next_page     = m_pages.size();
-        m_next_addr     = _space;
-        m_next_offset   = 0;
+    void swap(graph_allocator& rhs) noexcept
+    {
+        std::swap(m_chunks, rhs.m_chunks);
+        std::swap(m_free, rhs.m_free);
+        std::swap(m_next, rhs.m_next);
+        std::swap(m_last, rhs.m_last);
+    }
 
-        boolvec_t avail(m_alloc_per_page, true);
-        m_pages.resize(m_pages.size() + npages, nullptr);
-        m_offset_empty.resize(m_offset_empty.size() + npages, m_alloc_per_page);
-        m_offset_avail.resize(m_offset_avail.size() + npages, avail);
+    TIMEMORY_NODISCARD size_t alloc_bytes() const
+    {
+        size_t _n = 0;
+        for(const auto& itr : m_chunks)
+            _n += itr.size;
+        return _n * sizeof(slot_type);
+    }
 
-        for(int i = 0; i < npages; ++i)
+    TIMEMORY_NODISCARD size_t num_chunks() const { return m_chunks.size(); }
+
+private:
+    void add_chunk(size_t _min_size)
+    {
+        size_t _size = (m_chunks.empty()) ? min_chunk_size : (2 * m_chunks.back().size);
+        _size        = (_size > max_chunk_size) ? max_chunk_size : _size;
+        _size        = (_size < _min_size) ? _min_size : _size;
+        // the space remaining in the current chunk is recycled into the free-list
+        while(m_next != m_last)
         {
-            char* _ptr = (char*) _space;
-            _ptr += (i * units::get_page_size());
-            m_pages[_num_pages + i] = (void*) _ptr;
+            m_next->next = m_free;
+            m_free       = m_next++;
         }
+        m_chunks.emplace_back(chunk_type{ new slot_type[_size], _size });
+        m_next = m_chunks.back().data;
+        m_last = m_next + _size;
     }
 
-    const uint16_t                 m_alloc_per_page = units::get_page_size() / sizeof(Tp);
-    mutable uint16_t               m_next_offset    = 0;
-    mutable size_t                 m_next_page      = 0;
-    mutable void*                  m_next_addr      = nullptr;
-    mutable voidvec_t              m_pages          = {};
-    mutable sizevec_t              m_offset_empty   = {};
-    mutable std::vector<boolvec_t> m_offset_avail   = {};
-    mutable voidvec_t              m_allocations    = {};
+private:
+    std::vector<chunk_type> m_chunks = {};
+    slot_type*              m_free   = nullptr;
+    slot_type*              m_next   = nullptr;
+    slot_type*              m_last   = nullptr;
 };
-
-#endif  // defined(TIMEMORY_GRAPH_ALLOCATOR)
+//
+//--------------------------------------------------------------------------------------//
+//
+namespace impl
+{
+/// whether the allocator can release all of its memory at once
+template <typename AllocT, typename = void>
+struct graph_allocator_has_release : std::false_type
+{};
+//
+template <typename AllocT>
+struct graph_allocator_has_release<AllocT,
+                                   decltype(std::declval<AllocT&>().release(), void())>
+: std::true_type
+{};
+//
+template <typename AllocT>
+auto
+graph_allocator_release(AllocT& _alloc, int) -> decltype(_alloc.release(), void())
+{
+    _alloc.release();
+}
+//
+template <typename AllocT>
+void
+graph_allocator_release(AllocT&, long)
+{}
+//
+/// transfers ownership of node memory from one allocator to another
+template <typename AllocT>
+auto
+graph_allocator_absorb(AllocT& _lhs, AllocT& _rhs, int)
+    -> decltype(_lhs.absorb(_rhs), void())
+{
+    _lhs.absorb(_rhs);
+}
+//
+template <typename AllocT>
+void
+graph_allocator_absorb(AllocT&, AllocT&, long)
+{}
+}  // namespace impl
 
 //======================================================================================//
 
@@ -336,6 +375,9 @@ class graph
 {
 protected:
     using graph_node = tgraph_node<T>;
+    // head/feet are not allocated w/ AllocatorT so that clear() can release all the
+    // memory held by the allocator
+    using sentinel_allocator_t = std::allocator<graph_node>;
 
 public:
     /// Value of the data stored at a node.
@@ -785,16 +827,11 @@ graph<T, AllocatorT>::graph(const T& x)
 template <typename T, typename AllocatorT>
 graph<T, AllocatorT>::graph(graph<T, AllocatorT>&& x) noexcept
 {
+    // the nodes are owned by the allocator so the allocator moves with them
     m_head_initialize();
-    if(x.head->next_sibling != x.feet)
-    {  // move graph if non-empty only
-        head->next_sibling                 = x.head->next_sibling;
-        feet->prev_sibling                 = x.head->prev_sibling;
-        x.head->next_sibling->prev_sibling = head;
-        x.feet->prev_sibling->next_sibling = feet;
-        x.head->next_sibling               = x.feet;
-        x.feet->prev_sibling               = x.head;
-    }
+    std::swap(head, x.head);
+    std::swap(feet, x.feet);
+    std::swap(m_alloc, x.m_alloc);
 }
 
 //--------------------------------------------------------------------------------------//
@@ -813,10 +850,11 @@ template <typename T, typename AllocatorT>
 graph<T, AllocatorT>::~graph()
 {
     clear();
-    m_alloc.destroy(head);
-    m_alloc.destroy(feet);
-    m_alloc.deallocate(head, 1);
-    m_alloc.deallocate(feet, 1);
+    sentinel_allocator_t _alloc{};
+    _alloc.destroy(head);
+    _alloc.destroy(feet);
+    _alloc.deallocate(head, 1);
+    _alloc.deallocate(feet, 1);
 }
 
 //--------------------------------------------------------------------------------------//
@@ -825,10 +863,11 @@ template <typename T, typename AllocatorT>
 void
 graph<T, AllocatorT>::m_head_initialize()
 {
-    head = m_alloc.allocate(1, nullptr);  // MSVC does not have default second argument
-    feet = m_alloc.allocate(1, nullptr);
-    m_alloc.construct(head, std::move(tgraph_node<T>{}));
-    m_alloc.construct(feet, std::move(tgraph_node<T>{}));
+    sentinel_allocator_t _alloc{};
+    head = _alloc.allocate(1, nullptr);  // MSVC does not have default second argument
+    feet = _alloc.allocate(1, nullptr);
+    _alloc.construct(head, std::move(tgraph_node<T>{}));
+    _alloc.construct(feet, std::move(tgraph_node<T>{}));
 
     head->parent       = nullptr;
     head->first_child  = nullptr;
@@ -862,12 +901,10 @@ graph<T, AllocatorT>::operator=(graph<T, AllocatorT>&& x) noexcept
 {
     if(this != &x)
     {
-        head->next_sibling                 = x.head->next_sibling;
-        feet->prev_sibling                 = x.head->prev_sibling;
-        x.head->next_sibling->prev_sibling = head;
-        x.feet->prev_sibling->next_sibling = feet;
-        x.head->next_sibling               = x.feet;
-        x.feet->prev_sibling               = x.head;
+        // the previous contents are destroyed with x
+        std::swap(head, x.head);
+        std::swap(feet, x.feet);
+        std::swap(m_alloc, x.m_alloc);
     }
     return *this;
 }
@@ -915,11 +952,39 @@ template <typename T, typename AllocatorT>
 void
 graph<T, AllocatorT>::clear()
 {
-    if(head)
+    if(!head || head->next_sibling == feet)
+        return;
+
+    // destroy every node in post-order so the links are read before the node is
+    // destroyed. If the allocator supports it, all the memory is handed back in one
+    // call instead of deallocating node-by-node
+    constexpr bool _release = impl::graph_allocator_has_release<AllocatorT>::value;
+
+    auto _leftmost = [](graph_node* _node) {
+        while(_node->first_child)
+            _node = _node->first_child;
+        return _node;
+    };
+
+    graph_node* _cur = _leftmost(head->next_sibling);
+    while(_cur && _cur != feet)
     {
-        while(head->next_sibling != feet)
-            erase(pre_order_iterator(head->next_sibling));
+        graph_node* _next = _cur->parent;
+        if(_cur->next_sibling == feet)
+            _next = feet;
+        else if(_cur->next_sibling)
+            _next = _leftmost(_cur->next_sibling);
+        m_alloc.destroy(_cur);
+        if(!_release)
+            m_alloc.deallocate(_cur, 1);
+        _cur = _next;
     }
+
+    head->next_sibling = feet;
+    feet->prev_sibling = head;
+
+    if(_release)
+        impl::graph_allocator_release(m_alloc, 0);
 }
 
 //--------------------------------------------------------------------------------------//
@@ -2019,6 +2084,15 @@ template <typename T, typename AllocatorT>
 graph<T, AllocatorT>
 graph<T, AllocatorT>::move_out(iterator source)
 {
+    // nodes cannot be handed to another graph w/o the memory owned by this allocator
+    // so copy the subgraph and erase it
+    if(!std::allocator_traits<AllocatorT>::is_always_equal::value)
+    {
+        graph ret(source);
+        erase(source);
+        return ret;
+    }
+
     graph ret;
 
     // Move source node into the 'ret' graph.
@@ -2075,6 +2149,9 @@ graph<T, AllocatorT>::move_in(IterT loc, graph& other)
     other.head->next_sibling = other.feet;
     other.feet->prev_sibling = other.head;
 
+    // other is now empty so this graph takes ownership of the node memory
+    impl::graph_allocator_absorb(m_alloc, other.m_alloc, 0);
+
     return other_first_head;
 }
 
@@ -2151,6 +2228,9 @@ graph<T, AllocatorT>::move_in_as_nth_child(IterT loc, size_t n, graph& other)
     other.head->next_sibling = other.feet;
     other.feet->prev_sibling = other.head;
 
+    // other is now empty so this graph takes ownership of the node memory
+    impl::graph_allocator_absorb(m_alloc, other.m_alloc, 0);
+
     return other_first_head;
 }
 
@@ -35,6 +35,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <sstream>
 #include <string>
@@ -65,6 +66,8 @@ public:
     using inverse_insert_t   = std::vector<std::pair<int64_t, iterator>>;
     using pre_order_iterator = typename graph_t::pre_order_iterator;
     using sibling_iterator   = typename graph_t::sibling_iterator;
+    using mutex_t            = std::mutex;
+    using lock_t             = std::unique_lock<mutex_t>;
 
 public:
     // graph_data() = default;
@@ -122,8 +125,14 @@ public:
         }
     }
 
+    /// the structure of the graph is only modified while this mutex is held so that
+    /// another thread can walk the graph (e.g. for a snapshot) while it is in use.
+    /// Updates to the data in the existing nodes do not acquire it
+    mutex_t& structure_mutex() const { return m_mutex; }
+
     inline void clear()
     {
+        lock_t _lk{ m_mutex };
         m_graph.clear();
         m_has_head  = false;
         m_depth     = 0;
@@ -156,6 +165,7 @@ public:
 
         NodeT node(_id, NodeT::get_dummy(), _depth, threading::get_id(),
                    process::get_id(), true);
+        lock_t _lk{ m_mutex };
         m_depth     = _depth;
         m_sea_level = _depth;
         m_current   = m_graph.insert_after(m_head, node);
@@ -163,8 +173,33 @@ public:
         m_dummies.insert({ m_depth, m_current });
     }
 
+    /// copy a bookmark (and its children) from the graph of another worker-thread
+    inline iterator add_dummy(iterator _other)
+    {
+        lock_t _lk{ m_mutex };
+        auto   _itr = m_graph.insert_subgraph_after(m_head, _other);
+        m_dummies.insert({ _itr->depth(), _itr });
+        return _itr;
+    }
+
+    /// find the first bookmark equivalent to the given node
+    TIMEMORY_NODISCARD inline iterator find_dummy(iterator _itr) const
+    {
+        if(!_itr)
+            return nullptr;
+
+        auto _range = m_dummies.equal_range(_itr->depth());
+        for(auto ditr = _range.first; ditr != _range.second; ++ditr)
+        {
+            if(*ditr->second == *_itr)
+                return ditr->second;
+        }
+        return nullptr;
+    }
+
     inline void reset()
     {
+        lock_t _lk{ m_mutex };
         m_graph.erase_children(m_head);
         m_depth   = 0;
         m_current = m_head;
@@ -223,17 +258,20 @@ public:
 
     inline iterator append_child(NodeT& node)
     {
+        lock_t _lk{ m_mutex };
         ++m_depth;
         return (m_current = m_graph.append_child(m_current, node));
     }
 
     inline iterator append_head(NodeT& node)
     {
+        lock_t _lk{ m_mutex };
         return m_graph.append_child(m_head, node);
     }
 
     inline iterator emplace_child(iterator _itr, NodeT& node)
     {
+        lock_t _lk{ m_mutex };
         return m_graph.append_child(_itr, node);
     }
 
@@ -255,6 +293,7 @@ private:
     iterator                         m_head    = nullptr;
     graph_data*                      m_master  = nullptr;
     std::multimap<int64_t, iterator> m_dummies = {};
+    mutable mutex_t                  m_mutex;
 };
 //
 //--------------------------------------------------------------------------------------//
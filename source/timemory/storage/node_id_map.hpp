@@ -0,0 +1,252 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * \file timemory/storage/node_id_map.hpp
+ * \brief Flat open-addressing table mapping (depth, hash) to a graph iterator
+ */
+
+#pragma once
+
+#include "timemory/utility/macros.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace tim
+{
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \class tim::node_id_map
+/// \tparam Tp mapped type (typically a graph iterator)
+///
+/// \brief Open-addressing (linear-probing) hash table keyed on the (depth, hash) pair
+/// used by \ref tim::storage to locate existing call-graph nodes. All the slots are
+/// stored contiguously so a lookup is a single probe sequence over one array instead
+/// of two hash-map lookups and a node allocation per new entry.
+template <typename Tp>
+class node_id_map
+{
+public:
+    using this_type   = node_id_map<Tp>;
+    using key_type    = std::pair<int64_t, int64_t>;
+    using mapped_type = Tp;
+    using size_type   = size_t;
+
+    struct slot_type
+    {
+        int64_t depth = 0;
+        int64_t hash  = 0;
+        Tp      value = {};
+        bool    used  = false;
+    };
+
+    using slot_array_t = std::vector<slot_type>;
+
+public:
+    node_id_map() { reserve(64); }
+    explicit node_id_map(size_type _capacity) { reserve(_capacity); }
+    ~node_id_map() = default;
+
+    node_id_map(const this_type&) = default;
+    node_id_map(this_type&&)      = default;
+    this_type& operator=(const this_type&) = default;
+    this_type& operator=(this_type&&) = default;
+
+    TIMEMORY_NODISCARD bool      empty() const { return m_size == 0; }
+    TIMEMORY_NODISCARD size_type size() const { return m_size; }
+    TIMEMORY_NODISCARD size_type capacity() const { return m_slots.size(); }
+
+    /// returns a pointer to the mapped value or nullptr if the key does not exist
+    Tp* find(int64_t _depth, int64_t _hash)
+    {
+        if(m_slots.empty())
+            return nullptr;
+        auto _idx = probe(_depth, _hash);
+        return (m_slots[_idx].used) ? &m_slots[_idx].value : nullptr;
+    }
+
+    TIMEMORY_NODISCARD const Tp* find(int64_t _depth, int64_t _hash) const
+    {
+        if(m_slots.empty())
+            return nullptr;
+        auto _idx = probe(_depth, _hash);
+        return (m_slots[_idx].used) ? &m_slots[_idx].value : nullptr;
+    }
+
+    TIMEMORY_NODISCARD bool contains(int64_t _depth, int64_t _hash) const
+    {
+        return find(_depth, _hash) != nullptr;
+    }
+
+    /// returns a reference to the mapped value, default-inserting if it does not exist
+    Tp& operator()(int64_t _depth, int64_t _hash)
+    {
+        if(m_slots.empty())
+            reserve(64);
+        auto _idx = probe(_depth, _hash);
+        if(!m_slots[_idx].used)
+        {
+            if(2 * (m_size + 1) > m_slots.size())
+            {
+                rehash(2 * m_slots.size());
+                _idx = probe(_depth, _hash);
+            }
+            m_slots[_idx].depth = _depth;
+            m_slots[_idx].hash  = _hash;
+            m_slots[_idx].value = Tp{};
+            m_slots[_idx].used  = true;
+            ++m_size;
+        }
+        return m_slots[_idx].value;
+    }
+
+    /// insert or overwrite the value for the key
+    Tp& insert(int64_t _depth, int64_t _hash, const Tp& _value)
+    {
+        return ((*this)(_depth, _hash) = _value);
+    }
+
+    /// remove the key. Uses backward-shift deletion so no tombstones are left behind
+    bool erase(int64_t _depth, int64_t _hash)
+    {
+        if(m_slots.empty())
+            return false;
+        auto _idx = probe(_depth, _hash);
+        if(!m_slots[_idx].used)
+            return false;
+
+        auto _mask = m_slots.size() - 1;
+        auto _hole = _idx;
+        auto _next = (_idx + 1) & _mask;
+        while(m_slots[_next].used)
+        {
+            auto _home = bucket(m_slots[_next].depth, m_slots[_next].hash);
+            // move the entry into the hole if its home bucket is not in (hole, next]
+            if(((_next - _home) & _mask) >= ((_next - _hole) & _mask))
+            {
+                m_slots[_hole] = m_slots[_next];
+                _hole          = _next;
+            }
+            _next = (_next + 1) & _mask;
+        }
+        m_slots[_hole] = slot_type{};
+        --m_size;
+        return true;
+    }
+
+    /// remove all entries but keep the allocated slots
+    void clear()
+    {
+        for(auto& itr : m_slots)
+            itr = slot_type{};
+        m_size = 0;
+    }
+
+    /// ensure at least \param _n entries can be stored without rehashing
+    void reserve(size_type _n)
+    {
+        size_type _cap = 8;
+        while(_cap < 2 * _n)
+            _cap *= 2;
+        if(_cap > m_slots.size())
+            rehash(_cap);
+    }
+
+    /// invoke \param _func with (depth, hash, value) for every entry
+    template <typename FuncT>
+    void for_each(FuncT&& _func)
+    {
+        for(auto& itr : m_slots)
+        {
+            if(itr.used)
+                _func(itr.depth, itr.hash, itr.value);
+        }
+    }
+
+    template <typename FuncT>
+    void for_each(FuncT&& _func) const
+    {
+        for(const auto& itr : m_slots)
+        {
+            if(itr.used)
+                _func(itr.depth, itr.hash, itr.value);
+        }
+    }
+
+private:
+    static uint64_t mix(int64_t _depth, int64_t _hash)
+    {
+        // the hash is usually already well distributed but the depth is a small
+        // integer and flat/timeline hashes can be sequential so finalize w/ splitmix64
+        uint64_t _v = static_cast<uint64_t>(_hash) ^
+                      (static_cast<uint64_t>(_depth) * 0x9E3779B97F4A7C15ULL);
+        _v = (_v ^ (_v >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        _v = (_v ^ (_v >> 27)) * 0x94D049BB133111EBULL;
+        return _v ^ (_v >> 31);
+    }
+
+    TIMEMORY_NODISCARD size_type bucket(int64_t _depth, int64_t _hash) const
+    {
+        return static_cast<size_type>(mix(_depth, _hash)) & (m_slots.size() - 1);
+    }
+
+    /// returns the index of the matching slot or the first unused slot in the sequence
+    TIMEMORY_NODISCARD size_type probe(int64_t _depth, int64_t _hash) const
+    {
+        auto _mask = m_slots.size() - 1;
+        auto _idx  = bucket(_depth, _hash);
+        while(m_slots[_idx].used &&
+              (m_slots[_idx].hash != _hash || m_slots[_idx].depth != _depth))
+            _idx = (_idx + 1) & _mask;
+        return _idx;
+    }
+
+    void rehash(size_type _cap)
+    {
+        slot_array_t _old(_cap);
+        std::swap(_old, m_slots);
+        m_size = 0;
+        for(auto& itr : _old)
+        {
+            if(itr.used)
+            {
+                auto _idx     = probe(itr.depth, itr.hash);
+                m_slots[_idx] = std::move(itr);
+                ++m_size;
+            }
+        }
+    }
+
+private:
+    size_type    m_size  = 0;
+    slot_array_t m_slots = {};
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+}  // namespace tim
@@ -0,0 +1,118 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * \file timemory/storage/pointer_stack.hpp
+ * \brief Contiguous LIFO stack of component pointers w/ out-of-order removal
+ */
+
+#pragma once
+
+#include "timemory/utility/macros.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+namespace tim
+{
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \class tim::pointer_stack
+/// \tparam Tp Component type
+///
+/// \brief Tracks the components which are currently pushed to storage. Components are
+/// almost always popped in the reverse order they were pushed so \ref pop checks the
+/// top of the stack first and only falls back to a linear search for out-of-order pops.
+/// The buffer never shrinks so once the maximum call-depth has been reached, push/pop
+/// never allocate.
+template <typename Tp>
+class pointer_stack
+{
+public:
+    using this_type      = pointer_stack<Tp>;
+    using value_type     = Tp*;
+    using container_type = std::vector<Tp*>;
+    using iterator       = typename container_type::iterator;
+    using const_iterator = typename container_type::const_iterator;
+    using size_type      = typename container_type::size_type;
+
+public:
+    pointer_stack() { m_data.reserve(64); }
+    explicit pointer_stack(size_type _capacity) { m_data.reserve(_capacity); }
+    ~pointer_stack() = default;
+
+    pointer_stack(const this_type&) = default;
+    pointer_stack(this_type&&)      = default;
+    this_type& operator=(const this_type&) = default;
+    this_type& operator=(this_type&&) = default;
+
+    TIMEMORY_NODISCARD bool      empty() const { return m_data.empty(); }
+    TIMEMORY_NODISCARD size_type size() const { return m_data.size(); }
+    TIMEMORY_NODISCARD size_type capacity() const { return m_data.capacity(); }
+
+    void push(Tp* _obj) { m_data.emplace_back(_obj); }
+
+    /// remove the entry, returns false if it was not found
+    bool pop(Tp* _obj)
+    {
+        if(m_data.empty())
+            return false;
+        // fast path: LIFO
+        if(m_data.back() == _obj)
+        {
+            m_data.pop_back();
+            return true;
+        }
+        // slow path: out-of-order pop, search from the top since that is most likely
+        auto ritr = std::find(m_data.rbegin(), m_data.rend(), _obj);
+        if(ritr == m_data.rend())
+            return false;
+        m_data.erase(std::next(ritr).base());
+        return true;
+    }
+
+    TIMEMORY_NODISCARD bool contains(const Tp* _obj) const
+    {
+        return std::find(m_data.begin(), m_data.end(), _obj) != m_data.end();
+    }
+
+    /// does not release the memory
+    void clear() { m_data.clear(); }
+
+    iterator begin() { return m_data.begin(); }
+    iterator end() { return m_data.end(); }
+
+    TIMEMORY_NODISCARD const_iterator begin() const { return m_data.begin(); }
+    TIMEMORY_NODISCARD const_iterator end() const { return m_data.end(); }
+
+private:
+    container_type m_data = {};
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+}  // namespace tim
@@ -0,0 +1,246 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * \file timemory/storage/timeline_buffer.hpp
+ * \brief Bounded chunked buffer of fixed-size timeline events w/ optional spill-to-disk
+ */
+
+#pragma once
+
+#include "timemory/macros/os.hpp"
+#include "timemory/utility/macros.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(_UNIX)
+#    include <cstdlib>
+#    include <unistd.h>
+#endif
+
+namespace tim
+{
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \class tim::timeline_buffer
+/// \tparam Tp Trivially copyable event type
+///
+/// \brief Holds at most \ref capacity events in memory in fixed-size chunks which are
+/// allocated once and recycled. When the buffer is full, the oldest chunk is either
+/// written to an (unlinked) temporary file in the spill folder or discarded. Nothing is
+/// allocated or written on \ref push_back until a chunk fills up. The optional
+/// observer is invoked with the events of each chunk once it is full and with the
+/// remaining events on \ref clear, i.e. exactly once per event.
+template <typename Tp>
+class timeline_buffer
+{
+    static_assert(std::is_trivially_copyable<Tp>::value,
+                  "timeline_buffer requires a trivially copyable event type");
+
+public:
+    using this_type  = timeline_buffer<Tp>;
+    using value_type = Tp;
+    using chunk_type = std::vector<Tp>;
+    using size_type  = size_t;
+    using observer_t = std::function<void(const Tp*, size_type)>;
+
+    static constexpr size_type default_chunk_size = 4096;
+
+public:
+    explicit timeline_buffer(size_type _capacity, std::string _spill_path = {},
+                             size_type _chunk_size = default_chunk_size)
+    : m_chunk_size{ std::max<size_type>(std::min(_chunk_size, _capacity), 1) }
+    , m_max_chunks{ std::max<size_type>(_capacity / m_chunk_size, 1) }
+    , m_spill_path{ std::move(_spill_path) }
+    {}
+
+    ~timeline_buffer() { close(); }
+
+    timeline_buffer(const this_type&) = delete;
+    timeline_buffer(this_type&&)      = delete;
+    this_type& operator=(const this_type&) = delete;
+    this_type& operator=(this_type&&) = delete;
+
+    void push_back(const Tp& _v)
+    {
+        if(m_chunks.empty() || m_chunks.back().size() == m_chunk_size)
+            next_chunk();
+        auto& _chunk = m_chunks.back();
+        _chunk.emplace_back(_v);
+        if(m_observer && _chunk.size() == m_chunk_size)
+            m_observer(_chunk.data(), _chunk.size());
+    }
+
+    void set_observer(observer_t _func) { m_observer = std::move(_func); }
+    TIMEMORY_NODISCARD bool has_observer() const { return static_cast<bool>(m_observer); }
+
+    /// number of events in memory and on disk
+    TIMEMORY_NODISCARD size_type size() const
+    {
+        size_type _n = m_spilled;
+        for(const auto& itr : m_chunks)
+            _n += itr.size();
+        return _n;
+    }
+
+    TIMEMORY_NODISCARD bool      empty() const { return size() == 0; }
+    TIMEMORY_NODISCARD size_type capacity() const { return m_chunk_size * m_max_chunks; }
+    TIMEMORY_NODISCARD size_type spilled() const { return m_spilled; }
+    TIMEMORY_NODISCARD size_type dropped() const { return m_dropped; }
+
+    /// invokes \param _func on every event from the oldest to the newest. The spilled
+    /// events are read back in chunks
+    template <typename FuncT>
+    void for_each(FuncT&& _func)
+    {
+        if(m_file && m_spilled > 0)
+        {
+            fflush(m_file);
+            fseek(m_file, 0, SEEK_SET);
+            chunk_type _chunk(m_chunk_size);
+            size_type  _n = 0;
+            while((_n = fread(_chunk.data(), sizeof(Tp), _chunk.size(), m_file)) > 0)
+            {
+                for(size_type i = 0; i < _n; ++i)
+                    _func(_chunk[i]);
+            }
+            fseek(m_file, 0, SEEK_END);
+        }
+        for(const auto& itr : m_chunks)
+        {
+            for(const auto& eitr : itr)
+                _func(eitr);
+        }
+    }
+
+    /// discards all the events, keeps the memory of the chunks
+    void clear()
+    {
+        // the full chunks have already been observed
+        if(m_observer && !m_chunks.empty() && !m_chunks.back().empty() &&
+           m_chunks.back().size() < m_chunk_size)
+            m_observer(m_chunks.back().data(), m_chunks.back().size());
+        for(auto& itr : m_chunks)
+            itr.clear();
+        m_free.insert(m_free.end(), std::make_move_iterator(m_chunks.begin()),
+                      std::make_move_iterator(m_chunks.end()));
+        m_chunks.clear();
+        close();
+        m_spilled = 0;
+        m_dropped = 0;
+    }
+
+private:
+    void next_chunk()
+    {
+        if(m_chunks.size() == m_max_chunks)
+        {
+            auto _oldest = std::move(m_chunks.front());
+            m_chunks.pop_front();
+            if(spill(_oldest))
+                m_spilled += _oldest.size();
+            else
+                m_dropped += _oldest.size();
+            _oldest.clear();
+            m_chunks.emplace_back(std::move(_oldest));
+        }
+        else if(!m_free.empty())
+        {
+            m_chunks.emplace_back(std::move(m_free.back()));
+            m_free.pop_back();
+        }
+        else
+        {
+            m_chunks.emplace_back();
+            m_chunks.back().reserve(m_chunk_size);
+        }
+    }
+
+    bool spill(const chunk_type& _chunk)
+    {
+        if(m_spill_path.empty())
+            return false;
+        if(!m_file)
+            open();
+        if(!m_file)
+            return false;
+        return fwrite(_chunk.data(), sizeof(Tp), _chunk.size(), m_file) == _chunk.size();
+    }
+
+    void open()
+    {
+#if defined(_UNIX)
+        // the file is unlinked immediately so it is removed when it is closed, even if
+        // the process terminates abnormally
+        auto _fname = m_spill_path + "/.timemory-timeline-XXXXXX";
+        int  _fd    = mkstemp(&_fname[0]);
+        if(_fd < 0)
+        {
+            m_spill_path.clear();
+            return;
+        }
+        unlink(_fname.c_str());
+        m_file = fdopen(_fd, "w+b");
+        if(!m_file)
+            ::close(_fd);
+#else
+        m_file = tmpfile();
+#endif
+        // do not try again
+        if(!m_file)
+            m_spill_path.clear();
+    }
+
+    void close()
+    {
+        if(m_file)
+            fclose(m_file);
+        m_file = nullptr;
+    }
+
+private:
+    size_type               m_chunk_size = default_chunk_size;
+    size_type               m_max_chunks = 1;
+    size_type               m_spilled    = 0;
+    size_type               m_dropped    = 0;
+    std::string             m_spill_path = {};
+    FILE*                   m_file       = nullptr;
+    std::deque<chunk_type>  m_chunks     = {};
+    std::vector<chunk_type> m_free       = {};
+    observer_t              m_observer   = {};
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+}  // namespace tim
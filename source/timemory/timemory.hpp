@@ -122,6 +122,10 @@ struct dummy
 #        define TIMEMORY_MARKER(...)
 #    endif
 
+#    if !defined(TIMEMORY_LITERAL_MARKER)
+#        define TIMEMORY_LITERAL_MARKER(...)
+#    endif
+
 // define an unique pointer object
 #    if !defined(TIMEMORY_BLANK_POINTER)
 #        define TIMEMORY_BLANK_POINTER(...)
@@ -0,0 +1,238 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * \file timemory/utility/slot_pool.hpp
+ * \brief Pool of objects addressed by 64-bit handles encoding a slot index and a
+ * generation
+ */
+
+#pragma once
+
+#include "timemory/utility/macros.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace tim
+{
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \class tim::slot_pool
+/// \tparam Tp Object type
+/// \tparam BlockBits log2 of the number of slots allocated at once
+/// \tparam MaxBlocks maximum number of blocks
+///
+/// \brief Hands out objects by a 64-bit handle where the lower 32 bits are the slot
+/// index and the upper 32 bits are the generation of the slot. The generation is odd
+/// while the slot is in use and is incremented when the object is constructed and when
+/// it is released, so a stale or repeated handle never matches a live object.
+/// Slots are allocated in blocks which are never moved or freed so \ref get and
+/// \ref release do not take a lock and a handle may be released on any thread.
+/// Acquiring a slot only locks the free-list.
+template <typename Tp, size_t BlockBits = 10, size_t MaxBlocks = (1 << 14)>
+class slot_pool
+{
+public:
+    using this_type = slot_pool<Tp, BlockBits, MaxBlocks>;
+    using size_type = size_t;
+
+    static constexpr uint64_t block_size   = (static_cast<uint64_t>(1) << BlockBits);
+    static constexpr uint64_t block_mask   = block_size - 1;
+    static constexpr uint64_t max_capacity = block_size * MaxBlocks;
+    static constexpr uint64_t invalid_id   = ~static_cast<uint64_t>(0);
+
+    static_assert(max_capacity <= (static_cast<uint64_t>(1) << 32),
+                  "slot index must fit in 32 bits");
+
+private:
+    struct slot_type
+    {
+        using storage_t = typename std::aligned_storage<sizeof(Tp), alignof(Tp)>::type;
+
+        storage_t             data = {};
+        std::atomic<uint32_t> generation{ 0 };
+
+        Tp* get() { return reinterpret_cast<Tp*>(&data); }
+    };
+
+    using block_type = std::array<slot_type, block_size>;
+
+public:
+    slot_pool() = default;
+    ~slot_pool()
+    {
+        clear();
+        for(auto& itr : m_blocks)
+            delete itr.exchange(nullptr);
+    }
+
+    slot_pool(const this_type&) = delete;
+    slot_pool(this_type&&)      = delete;
+    this_type& operator=(const this_type&) = delete;
+    this_type& operator=(this_type&&) = delete;
+
+    static uint32_t index(uint64_t _id) { return static_cast<uint32_t>(_id); }
+    static uint32_t generation(uint64_t _id) { return static_cast<uint32_t>(_id >> 32); }
+    static uint64_t make_id(uint32_t _idx, uint32_t _gen)
+    {
+        return (static_cast<uint64_t>(_gen) << 32) | _idx;
+    }
+
+    /// number of live objects
+    TIMEMORY_NODISCARD size_type size() const { return m_size.load(); }
+    TIMEMORY_NODISCARD bool      empty() const { return size() == 0; }
+
+    /// constructs an object in a free slot and returns the handle. Returns
+    /// \ref invalid_id if the pool is exhausted
+    template <typename... Args>
+    uint64_t acquire(Args&&... _args)
+    {
+        uint32_t _idx = 0;
+        {
+            std::lock_guard<std::mutex> _lk{ m_mutex };
+            if(!m_free.empty())
+            {
+                _idx = m_free.back();
+                m_free.pop_back();
+            }
+            else
+            {
+                if(m_end == max_capacity)
+                    return invalid_id;
+                _idx = static_cast<uint32_t>(m_end++);
+                if((_idx & block_mask) == 0)
+                    m_blocks[_idx >> BlockBits].store(new block_type{},
+                                                      std::memory_order_release);
+            }
+        }
+
+        auto& _slot = get_slot(_idx);
+        new(&_slot.data) Tp(std::forward<Args>(_args)...);
+        auto _gen = _slot.generation.load(std::memory_order_relaxed) + 1;
+        _slot.generation.store(_gen, std::memory_order_release);
+        ++m_size;
+        return make_id(_idx, _gen);
+    }
+
+    /// returns nullptr if the handle is not live
+    Tp* get(uint64_t _id)
+    {
+        auto* _slot = find_slot(_id);
+        return (_slot) ? _slot->get() : nullptr;
+    }
+
+    /// invokes the function with the object and destroys it. Returns false if the
+    /// handle was not live (already released, stale, or never acquired)
+    template <typename FuncT>
+    bool release(uint64_t _id, FuncT&& _func)
+    {
+        auto* _slot = find_slot(_id);
+        if(!_slot)
+            return false;
+        // only one releaser of a handle wins
+        auto _gen = generation(_id);
+        if(!_slot->generation.compare_exchange_strong(_gen, _gen + 1))
+            return false;
+        std::forward<FuncT>(_func)(*_slot->get());
+        _slot->get()->~Tp();
+        --m_size;
+        std::lock_guard<std::mutex> _lk{ m_mutex };
+        m_free.emplace_back(index(_id));
+        return true;
+    }
+
+    bool release(uint64_t _id)
+    {
+        return release(_id, [](Tp&) {});
+    }
+
+    /// handles of all the live objects
+    std::vector<uint64_t> get_ids() const
+    {
+        std::vector<uint64_t> _ids{};
+        size_type             _end = 0;
+        {
+            std::lock_guard<std::mutex> _lk{ m_mutex };
+            _end = m_end;
+        }
+        for(size_type i = 0; i < _end; ++i)
+        {
+            auto* _block = m_blocks[i >> BlockBits].load(std::memory_order_acquire);
+            auto  _gen   = (*_block)[i & block_mask].generation.load();
+            if(_gen % 2 == 1)
+                _ids.emplace_back(make_id(static_cast<uint32_t>(i), _gen));
+        }
+        return _ids;
+    }
+
+    /// destroys the live objects. The slots are kept so handles from before the
+    /// clear remain invalid
+    void clear()
+    {
+        for(auto itr : get_ids())
+            release(itr);
+    }
+
+private:
+    slot_type& get_slot(uint32_t _idx)
+    {
+        return (*m_blocks[_idx >> BlockBits].load(std::memory_order_acquire))
+            [_idx & block_mask];
+    }
+
+    slot_type* find_slot(uint64_t _id)
+    {
+        auto _idx = index(_id);
+        auto _gen = generation(_id);
+        if(_gen % 2 == 0 || _idx >= max_capacity)
+            return nullptr;
+        auto* _block = m_blocks[_idx >> BlockBits].load(std::memory_order_acquire);
+        if(!_block)
+            return nullptr;
+        auto& _slot = (*_block)[_idx & block_mask];
+        return (_slot.generation.load(std::memory_order_acquire) == _gen) ? &_slot
+                                                                          : nullptr;
+    }
+
+private:
+    mutable std::mutex                              m_mutex  = {};
+    size_type                                       m_end    = 0;
+    std::atomic<size_type>                          m_size{ 0 };
+    std::vector<uint32_t>                           m_free   = {};
+    std::array<std::atomic<block_type*>, MaxBlocks> m_blocks = {};
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+}  // namespace tim
@@ -0,0 +1,191 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * \file timemory/utility/trace_writer.hpp
+ * \brief Streaming writer of the trace-event JSON format (chrome://tracing, Perfetto)
+ */
+
+#pragma once
+
+#include "timemory/utility/macros.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace tim
+{
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \class tim::trace_writer
+/// \brief Writes a trace-event JSON file incrementally. Callers format the events into
+/// their own buffer with the static functions (e.g. one buffer per thread) and pass
+/// the buffer to \ref write once it exceeds \ref buffer_size, so the trace is never
+/// held in memory and the file is only locked once per buffer. The closing brackets
+/// are written by \ref close (or the destructor).
+///
+/// \code{.cpp}
+/// tim::trace_writer _writer{ "trace.json" };
+/// std::string       _buffer{};
+/// tim::trace_writer::complete(_buffer, "main", pid, tid, ts_usec, dur_usec);
+/// if(_buffer.size() >= tim::trace_writer::buffer_size)
+///     _writer.write(_buffer);
+/// _writer.write(_buffer);
+/// _writer.close();
+/// \endcode
+class trace_writer
+{
+public:
+    using mutex_t = std::mutex;
+    using lock_t  = std::unique_lock<mutex_t>;
+
+    /// suggested size of the caller buffers
+    static constexpr size_t buffer_size = (1 << 20);
+
+public:
+    explicit trace_writer(std::string _fname)
+    : m_filename{ std::move(_fname) }
+    {
+        m_file = fopen(m_filename.c_str(), "w");
+        if(m_file)
+            fputs("{\"traceEvents\":[", m_file);
+    }
+
+    ~trace_writer() { close(); }
+
+    trace_writer(const trace_writer&) = delete;
+    trace_writer(trace_writer&&)      = delete;
+    trace_writer& operator=(const trace_writer&) = delete;
+    trace_writer& operator=(trace_writer&&) = delete;
+
+    TIMEMORY_NODISCARD bool is_open() const { return m_file != nullptr; }
+    TIMEMORY_NODISCARD const std::string& filename() const { return m_filename; }
+
+    /// writes the formatted events and clears the buffer
+    void write(std::string& _buffer)
+    {
+        if(_buffer.empty())
+            return;
+        lock_t _lk{ m_mutex };
+        if(m_file)
+        {
+            if(m_written)
+                fputc(',', m_file);
+            fwrite(_buffer.data(), sizeof(char), _buffer.size(), m_file);
+            m_written = true;
+        }
+        _buffer.clear();
+    }
+
+    void close()
+    {
+        lock_t _lk{ m_mutex };
+        if(!m_file)
+            return;
+        fputs("\n]}\n", m_file);
+        fclose(m_file);
+        m_file = nullptr;
+    }
+
+    /// append a complete ("X") event. The timestamp and the duration are in
+    /// microseconds
+    static void complete(std::string& _buffer, const std::string& _name, int64_t _pid,
+                         int64_t _tid, double _ts, double _dur)
+    {
+        char _tail[128];
+        snprintf(_tail, sizeof(_tail),
+                 "\",\"ph\":\"X\",\"pid\":%lli,\"tid\":%lli,\"ts\":%.3f,\"dur\":%.3f}",
+                 static_cast<long long>(_pid), static_cast<long long>(_tid), _ts, _dur);
+        begin_event(_buffer);
+        _buffer += "{\"name\":\"";
+        escape(_buffer, _name);
+        _buffer += _tail;
+    }
+
+    /// append a metadata ("M") event naming the thread
+    static void thread_name(std::string& _buffer, const std::string& _name, int64_t _pid,
+                            int64_t _tid)
+    {
+        char _head[128];
+        snprintf(_head, sizeof(_head),
+                 "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%lli,\"tid\":%lli,"
+                 "\"args\":{\"name\":\"",
+                 static_cast<long long>(_pid), static_cast<long long>(_tid));
+        begin_event(_buffer);
+        _buffer += _head;
+        escape(_buffer, _name);
+        _buffer += "\"}}";
+    }
+
+private:
+    static void begin_event(std::string& _buffer)
+    {
+        if(!_buffer.empty())
+            _buffer += ',';
+        _buffer += '\n';
+    }
+
+    static void escape(std::string& _buffer, const std::string& _str)
+    {
+        for(const auto& itr : _str)
+        {
+            switch(itr)
+            {
+                case '"': _buffer += "\\\""; break;
+                case '\\': _buffer += "\\\\"; break;
+                case '\n': _buffer += "\\n"; break;
+                case '\t': _buffer += "\\t"; break;
+                case '\r': _buffer += "\\r"; break;
+                default:
+                {
+                    if(static_cast<unsigned char>(itr) < 0x20)
+                    {
+                        char _code[8];
+                        snprintf(_code, sizeof(_code), "\\u%04x", (int) itr);
+                        _buffer += _code;
+                    }
+                    else
+                    {
+                        _buffer += itr;
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    bool        m_written  = false;
+    std::string m_filename = {};
+    FILE*       m_file     = nullptr;
+    mutex_t     m_mutex    = {};
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+}  // namespace tim
@@ -292,10 +292,12 @@ destroy(TupleT<Tp&...>&& obj)
 //                                  start
 //--------------------------------------------------------------------------------------//
 //
+namespace invoke_impl
+{
 template <typename ApiT, template <typename...> class TupleT, typename... Tp,
           typename... Args>
 void
-start(TupleT<Tp...>& obj, Args&&... args)
+start(false_type, TupleT<Tp...>& obj, Args&&... args)
 {
     using data_type        = std::tuple<remove_pointer_t<decay_t<Tp>>...>;
     using priority_types_t = mpl::filter_false_t<mpl::negative_start_priority, data_type>;
@@ -316,6 +318,27 @@ start(TupleT<Tp...>& obj, Args&&... args)
                                                         std::forward<Args>(args)...);
 }
 //
+// without arguments, the data source shared by several components is read once
+template <typename ApiT, template <typename...> class TupleT, typename... Tp>
+void
+start(true_type, TupleT<Tp...>& obj)
+{
+    operation::construct_shared_cache_t<Tp...> _cache{};
+    start<ApiT>(false_type{}, obj, _cache);
+}
+}  // namespace invoke_impl
+//
+template <typename ApiT, template <typename...> class TupleT, typename... Tp,
+          typename... Args>
+void
+start(TupleT<Tp...>& obj, Args&&... args)
+{
+    using shared_cache_t = operation::construct_shared_cache_t<Tp...>;
+    using use_cache_t    =
+        std::integral_constant<bool, (sizeof...(Args) == 0 && shared_cache_t::value)>;
+    invoke_impl::start<ApiT>(use_cache_t{}, obj, std::forward<Args>(args)...);
+}
+//
 template <template <typename...> class TupleT, typename... Tp, typename... Args>
 void
 start(TupleT<Tp...>& obj, Args&&... args)
@@ -362,10 +385,12 @@ start(TupleT<Tp&...>&& obj, Args&&... args)
 //                                  stop
 //--------------------------------------------------------------------------------------//
 //
+namespace invoke_impl
+{
 template <typename ApiT, template <typename...> class TupleT, typename... Tp,
           typename... Args>
 void
-stop(TupleT<Tp...>& obj, Args&&... args)
+stop(false_type, TupleT<Tp...>& obj, Args&&... args)
 {
     using data_type        = std::tuple<remove_pointer_t<decay_t<Tp>>...>;
     using priority_types_t = mpl::filter_false_t<mpl::negative_stop_priority, data_type>;
@@ -387,6 +412,27 @@ stop(TupleT<Tp...>& obj, Args&&... args)
                                                        std::forward<Args>(args)...);
 }
 //
+// without arguments, the data source shared by several components is read once
+template <typename ApiT, template <typename...> class TupleT, typename... Tp>
+void
+stop(true_type, TupleT<Tp...>& obj)
+{
+    operation::construct_shared_cache_t<Tp...> _cache{};
+    stop<ApiT>(false_type{}, obj, _cache);
+}
+}  // namespace invoke_impl
+//
+template <typename ApiT, template <typename...> class TupleT, typename... Tp,
+          typename... Args>
+void
+stop(TupleT<Tp...>& obj, Args&&... args)
+{
+    using shared_cache_t = operation::construct_shared_cache_t<Tp...>;
+    using use_cache_t    =
+        std::integral_constant<bool, (sizeof...(Args) == 0 && shared_cache_t::value)>;
+    invoke_impl::stop<ApiT>(use_cache_t{}, obj, std::forward<Args>(args)...);
+}
+//
 template <template <typename...> class TupleT, typename... Tp, typename... Args>
 void
 stop(TupleT<Tp...>& obj, Args&&... args)
@@ -137,6 +137,13 @@ using string = tim::mpl::apply<std::string>;
         TIMEMORY_AUTO_TYPE(TYPE)                                                         \
         _TIM_VARIABLE(__LINE__)(TIMEMORY_CAPTURE_ARGS(__VA_ARGS__))
 
+//--------------------------------------------------------------------------------------//
+//  LABEL must be a string literal: the hash is computed at
+//  compile-time so no source location, string, or runtime hash is created
+//
+#    define TIMEMORY_LITERAL_MARKER(TYPE, LABEL)                                         \
+        TIMEMORY_AUTO_TYPE(TYPE) _TIM_VARIABLE(__LINE__)(TIMEMORY_HASH_LITERAL(LABEL))
+
 //======================================================================================//
 //
 //                      CONDITIONAL MARKER MACROS
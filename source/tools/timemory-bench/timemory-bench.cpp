@@ -0,0 +1,566 @@
+//  MIT License
+//
+//  Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+#include "timemory-bench.hpp"
+//
+#include "timemory/components/properties.hpp"
+#include "timemory/timemory.hpp"
+#include "timemory/utility/argparse.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace tim::component;
+
+namespace bench
+{
+//--------------------------------------------------------------------------------------//
+//
+//      measurement
+//
+//--------------------------------------------------------------------------------------//
+
+config&
+get_config()
+{
+    static config _instance{};
+    return _instance;
+}
+
+//--------------------------------------------------------------------------------------//
+
+results_t&
+get_results()
+{
+    static results_t _instance{};
+    return _instance;
+}
+
+//--------------------------------------------------------------------------------------//
+
+bool
+is_selected(const std::string& _group, const std::string& _name)
+{
+    const auto& _filter = get_config().filter;
+    if(_filter.empty())
+        return true;
+    return std::regex_search(_group + "/" + _name,
+                             std::regex{ _filter, std::regex_constants::egrep });
+}
+
+//--------------------------------------------------------------------------------------//
+//
+//  invokes the function (which performs _nops operations) once to warm up and then
+//  config::repeat times. The mean and the minimum time per operation are recorded and
+//  the wall-clock call-graph of the calling thread is cleared
+//
+template <typename FuncT>
+void
+measure(const std::string& _group, const std::string& _name, int64_t _threads,
+        int64_t _depth, int64_t _nops, FuncT&& _func)
+{
+    if(!is_selected(_group, _name))
+        return;
+
+    using clock_type = std::chrono::steady_clock;
+    using duration_t = std::chrono::duration<double, std::nano>;
+
+    _func();
+
+    auto   _repeat = std::max<int64_t>(get_config().repeat, 1);
+    double _sum    = 0.0;
+    double _min    = std::numeric_limits<double>::max();
+    for(int64_t i = 0; i < _repeat; ++i)
+    {
+        auto _beg = clock_type::now();
+        _func();
+        auto _end = clock_type::now();
+        auto _val = duration_t{ _end - _beg }.count() / _nops;
+        _sum += _val;
+        _min = std::min(_min, _val);
+    }
+
+    // the entries of one benchmark must not change the cost of inserting into the
+    // call-graph for the next one
+    if(auto* _storage = tim::storage<wall_clock>::instance())
+        _storage->reset();
+
+    result _ret{ _group, _name, _threads, _depth, _nops, _sum / _repeat, _min };
+    if(get_config().verbose >= 0)
+        std::cout << _ret << std::endl;
+    get_results().emplace_back(std::move(_ret));
+}
+
+//--------------------------------------------------------------------------------------//
+//
+//      per-component
+//
+//--------------------------------------------------------------------------------------//
+
+template <typename Tp>
+std::string
+get_name()
+{
+    std::string _id = properties<Tp>::id();
+    return (_id.empty()) ? tim::demangle<Tp>() : _id;
+}
+
+//--------------------------------------------------------------------------------------//
+//
+//  start/stop of a single component without storage
+//
+template <typename Tp>
+void
+component_cost()
+{
+    if(is_excluded<Tp>::value || !tim::trait::runtime_enabled<Tp>::get())
+        return;
+
+    using bundle_t = tim::lightweight_tuple<Tp>;
+    auto _n        = static_cast<int64_t>(get_config().iterations);
+    measure("component", get_name<Tp>(), 1, 1, _n, [_n]() {
+        bundle_t _obj{ "bench" };
+        for(int64_t i = 0; i < _n; ++i)
+        {
+            _obj.start();
+            _obj.stop();
+        }
+    });
+}
+
+//--------------------------------------------------------------------------------------//
+
+template <typename... Tp>
+void
+component_costs(tim::type_list<Tp...>)
+{
+    TIMEMORY_FOLD_EXPRESSION(component_cost<Tp>());
+}
+
+//--------------------------------------------------------------------------------------//
+//
+//      per-bundle
+//
+//--------------------------------------------------------------------------------------//
+//
+//  construction + start + stop + destruction of a bundle with a fixed label
+//
+template <typename BundleT, typename... Args>
+void
+bundle_cost(const std::string& _group, const std::string& _name, Args&&... _args)
+{
+    auto _n     = static_cast<int64_t>(get_config().iterations);
+    auto _label = TIMEMORY_JOIN('/', "bench", _group, _name);
+    measure(_group, _name, 1, 1, _n, [&]() {
+        for(int64_t i = 0; i < _n; ++i)
+        {
+            BundleT _obj{ _label, _args... };
+            _obj.start();
+            _obj.stop();
+        }
+    });
+}
+
+//--------------------------------------------------------------------------------------//
+
+template <typename BundleT>
+void
+auto_bundle_cost(const std::string& _group, const std::string& _name)
+{
+    auto _n     = static_cast<int64_t>(get_config().iterations);
+    auto _label = TIMEMORY_JOIN('/', "bench", _group, _name);
+    measure(_group, _name, 1, 1, _n, [&]() {
+        for(int64_t i = 0; i < _n; ++i)
+        {
+            BundleT _obj{ _label };
+            tim::consume_parameters(_obj);
+        }
+    });
+}
+
+//--------------------------------------------------------------------------------------//
+
+void
+bundler_costs()
+{
+    using tuple_t  = tim::component_tuple<wall_clock>;
+    using list_t   = tim::component_list<wall_clock>;
+    using light_t  = tim::lightweight_tuple<wall_clock>;
+    using auto_t   = tim::auto_bundle<TIMEMORY_API, wall_clock>;
+    using user_t   = tim::component_tuple<user_global_bundle>;
+    using hybrid_t = tim::component_bundle<TIMEMORY_API, wall_clock, cpu_clock*>;
+
+    list_t::get_initializer() = [](list_t& cl) { cl.initialize<wall_clock>(); };
+    user_global_bundle::reset();
+    user_global_bundle::configure<wall_clock>();
+
+    bundle_cost<light_t>("bundler", "lightweight_tuple");
+    bundle_cost<tuple_t>("bundler", "component_tuple");
+    bundle_cost<list_t>("bundler", "component_list");
+    bundle_cost<hybrid_t>("bundler", "component_bundle");
+    auto_bundle_cost<auto_t>("bundler", "auto_bundle");
+    bundle_cost<user_t>("bundler", "user_bundle");
+}
+
+//--------------------------------------------------------------------------------------//
+//
+//      storage modes
+//
+//--------------------------------------------------------------------------------------//
+
+void
+storage_costs()
+{
+    using bundle_t = tim::component_tuple<wall_clock>;
+
+    bundle_cost<bundle_t>("storage", "tree", true, tim::scope::tree{});
+    bundle_cost<bundle_t>("storage", "flat", true, tim::scope::flat{});
+    bundle_cost<bundle_t>("storage", "timeline", true, tim::scope::timeline{});
+    bundle_cost<bundle_t>("storage", "none", false);
+}
+
+//--------------------------------------------------------------------------------------//
+//
+//      label lengths
+//
+//--------------------------------------------------------------------------------------//
+//
+//  the label is hashed on every construction
+//
+void
+label_costs()
+{
+    using bundle_t = tim::component_tuple<wall_clock>;
+
+    for(auto _len : get_config().label_lengths)
+    {
+        auto _label = std::string{ "bench/label/" };
+        _label.resize(std::max<size_t>(_len, _label.length()), 'x');
+        auto _n = static_cast<int64_t>(get_config().iterations);
+        measure("label", std::to_string(_len), 1, 1, _n, [&]() {
+            for(int64_t i = 0; i < _n; ++i)
+            {
+                bundle_t _obj{ _label };
+                _obj.start();
+                _obj.stop();
+            }
+        });
+    }
+}
+
+//--------------------------------------------------------------------------------------//
+//
+//      call depths
+//
+//--------------------------------------------------------------------------------------//
+
+void
+depth_costs()
+{
+    using bundle_t = tim::component_tuple<wall_clock>;
+
+    for(auto _depth : get_config().depths)
+    {
+        if(_depth == 0)
+            continue;
+
+        std::vector<std::string> _labels{};
+        for(size_t i = 0; i < _depth; ++i)
+            _labels.emplace_back(TIMEMORY_JOIN('/', "bench/depth", _depth, i));
+
+        // each iteration performs _depth start/stops
+        auto _n = std::max<int64_t>(get_config().iterations / _depth, 1);
+        std::vector<bundle_t> _stack{};
+        _stack.reserve(_depth);
+        measure("depth", std::to_string(_depth), 1, _depth, _n * _depth, [&]() {
+            for(int64_t i = 0; i < _n; ++i)
+            {
+                for(size_t j = 0; j < _depth; ++j)
+                {
+                    _stack.emplace_back(_labels[j]);
+                    _stack.back().start();
+                }
+                for(size_t j = 0; j < _depth; ++j)
+                {
+                    _stack.back().stop();
+                    _stack.pop_back();
+                }
+            }
+        });
+    }
+}
+
+//--------------------------------------------------------------------------------------//
+//
+//      thread counts
+//
+//--------------------------------------------------------------------------------------//
+//
+//  every thread performs config::iterations start/stops concurrently. The time per
+//  operation is the wall-clock time divided by the operations of one thread so the
+//  result is constant when the threads do not contend
+//
+void
+thread_costs()
+{
+    using bundle_t = tim::component_tuple<wall_clock>;
+
+    auto _max = std::max<size_t>(get_config().threads, 1);
+    for(size_t _nthreads = 1; _nthreads <= _max; ++_nthreads)
+    {
+        auto _n = static_cast<int64_t>(get_config().iterations);
+        measure("threads", std::to_string(_nthreads), _nthreads, 1, _n, [&]() {
+            std::atomic<size_t>      _ready{ 0 };
+            std::vector<std::thread> _threads{};
+            for(size_t t = 0; t < _nthreads; ++t)
+            {
+                _threads.emplace_back([&]() {
+                    ++_ready;
+                    while(_ready.load() < _nthreads)
+                        std::this_thread::yield();
+                    for(int64_t i = 0; i < _n; ++i)
+                    {
+                        bundle_t _obj{ "bench/threads" };
+                        _obj.start();
+                        _obj.stop();
+                    }
+                });
+            }
+            for(auto& itr : _threads)
+                itr.join();
+        });
+    }
+}
+
+//--------------------------------------------------------------------------------------//
+//
+//      /proc readers
+//
+//--------------------------------------------------------------------------------------//
+//
+//  start/stop of the components which read /proc/<pid>/statm and /proc/<pid>/io. The
+//  "ifstream" entries open and parse the file with a stream on every read, i.e. the
+//  cost without the persistent descriptors of tim::procfs
+//
+template <typename Tp>
+void
+procfs_cost()
+{
+    using bundle_t = tim::lightweight_tuple<Tp>;
+    auto _n        = static_cast<int64_t>(get_config().iterations);
+    measure("procfs", get_name<Tp>(), 1, 1, _n, [_n]() {
+        bundle_t _obj{ "bench" };
+        for(int64_t i = 0; i < _n; ++i)
+        {
+            _obj.start();
+            _obj.stop();
+        }
+    });
+}
+
+void
+procfs_costs()
+{
+#if defined(_LINUX)
+    procfs_cost<page_rss>();
+    procfs_cost<read_bytes>();
+    procfs_cost<written_bytes>();
+
+    auto _n = static_cast<int64_t>(get_config().iterations);
+    measure("procfs", "statm_ifstream", 1, 1, _n, [_n]() {
+        int64_t _sum = 0;
+        for(int64_t i = 0; i < 2 * _n; ++i)
+        {
+            std::stringstream _fname{};
+            _fname << "/proc/" << tim::process::get_target_id() << "/statm";
+            std::ifstream _ifs{ _fname.str() };
+            int64_t       _size = 0;
+            int64_t       _rss  = 0;
+            _ifs >> _size >> _rss;
+            _sum += _rss;
+        }
+        tim::consume_parameters(_sum);
+    });
+
+    measure("procfs", "io_ifstream", 1, 1, _n, [_n]() {
+        int64_t _sum = 0;
+        for(int64_t i = 0; i < 2 * _n; ++i)
+        {
+            std::array<int64_t, 5> _data{};
+            std::ifstream          _ifs{ tim::io_cache::get_filename() };
+            tim::io_cache::read(_ifs, _data, std::make_index_sequence<5>{});
+            _sum += _data.back();
+        }
+        tim::consume_parameters(_sum);
+    });
+#endif
+}
+
+//--------------------------------------------------------------------------------------//
+//
+//      output
+//
+//--------------------------------------------------------------------------------------//
+
+std::ostream&
+operator<<(std::ostream& _os, const result& _v)
+{
+    std::stringstream _ss;
+    _ss << std::setw(12) << std::left << _v.group << std::setw(40) << std::left
+        << _v.name << std::setw(8) << std::right << _v.threads << std::setw(8)
+        << std::right << _v.depth << std::setw(12) << std::right << std::fixed
+        << std::setprecision(2) << _v.mean << std::setw(12) << std::right << _v.min;
+    return (_os << _ss.str());
+}
+
+//--------------------------------------------------------------------------------------//
+
+void
+write_results()
+{
+    const auto& _fname = get_config().output;
+    if(_fname.empty())
+        return;
+
+    std::ofstream ofs{ _fname };
+    if(!ofs)
+    {
+        fprintf(stderr, "[timemory-bench]> Error opening '%s'\n", _fname.c_str());
+        return;
+    }
+
+    {
+        using json_type = tim::cereal::PrettyJSONOutputArchive;
+        json_type ar{ ofs };
+        ar.setNextName("timemory-bench");
+        ar.startNode();
+        ar(tim::cereal::make_nvp("version", std::string{ TIMEMORY_VERSION_STRING }),
+           tim::cereal::make_nvp("hardware_concurrency",
+                                 std::thread::hardware_concurrency()),
+           tim::cereal::make_nvp("config", get_config()),
+           tim::cereal::make_nvp("results", get_results()));
+        ar.finishNode();
+    }
+    ofs << std::endl;
+
+    if(get_config().verbose >= 0)
+        printf("[timemory-bench]> Outputting '%s'...\n", _fname.c_str());
+}
+}  // namespace bench
+
+//--------------------------------------------------------------------------------------//
+
+int
+main(int argc, char** argv)
+{
+    using parser_t = tim::argparse::argument_parser;
+    auto& _config  = bench::get_config();
+
+    parser_t parser("timemory-bench");
+
+    parser.enable_help();
+    parser.add_argument({ "-i", "--iterations" }, "Operations per measurement")
+        .count(1);
+    parser.add_argument({ "-r", "--repeat" }, "Measurements per benchmark")
+        .count(1);
+    parser.add_argument({ "-t", "--threads" }, "Maximum number of threads")
+        .count(1);
+    parser.add_argument({ "-d", "--depths" }, "Call-stack depths").min_count(1);
+    parser.add_argument({ "-l", "--label-lengths" }, "Label lengths").min_count(1);
+    parser
+        .add_argument({ "-f", "--filter" },
+                      "Only run benchmarks whose <group>/<name> matches the regex "
+                      "(groups: component, bundler, storage, label, depth, threads, procfs)")
+        .count(1);
+    parser.add_argument({ "-o", "--output" }, "JSON output file (empty to disable)")
+        .max_count(1);
+    parser.add_argument({ "-q", "--quiet" }, "Suppress the table").count(0);
+
+    auto err = parser.parse(argc, argv);
+    if(err)
+        std::cerr << err << std::endl;
+
+    if(err || parser.exists("help"))
+    {
+        parser.print_help();
+        return EXIT_FAILURE;
+    }
+
+    if(parser.exists("iterations"))
+        _config.iterations = parser.get<size_t>("iterations");
+    if(parser.exists("repeat"))
+        _config.repeat = parser.get<size_t>("repeat");
+    if(parser.exists("threads"))
+        _config.threads = parser.get<size_t>("threads");
+    if(parser.exists("depths"))
+        _config.depths = parser.get<std::vector<size_t>>("depths");
+    if(parser.exists("label-lengths"))
+        _config.label_lengths = parser.get<std::vector<size_t>>("label-lengths");
+    if(parser.exists("filter"))
+        _config.filter = parser.get<std::string>("filter");
+    if(parser.exists("output"))
+        _config.output = parser.get<std::string>("output");
+    if(parser.exists("quiet"))
+        _config.verbose = -1;
+
+    // the benchmark measures the cost of the instrumentation, not the output
+    tim::settings::auto_output() = false;
+    tim::settings::banner()      = false;
+    tim::timemory_init(argc, argv);
+
+    if(_config.verbose >= 0)
+    {
+        std::stringstream _ss;
+        _ss << std::setw(12) << std::left << "GROUP" << std::setw(40) << std::left
+            << "NAME" << std::setw(8) << std::right << "THREADS" << std::setw(8)
+            << std::right << "DEPTH" << std::setw(12) << std::right << "NS/OP"
+            << std::setw(12) << std::right << "MIN NS/OP";
+        std::cout << _ss.str() << std::endl;
+    }
+
+    bench::component_costs(tim::available_types_t{});
+    bench::bundler_costs();
+    bench::storage_costs();
+    bench::label_costs();
+    bench::depth_costs();
+    bench::thread_costs();
+    bench::procfs_costs();
+
+    bench::write_results();
+
+    tim::timemory_finalize();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,125 @@
+//  MIT License
+//
+//  Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+/** \file timemory-bench.hpp
+ * \brief Measures the cost of the instrumentation: every available component, the
+ * bundlers, the storage modes, label lengths, call-stack depths and thread counts
+ */
+
+#pragma once
+
+#include "timemory/mpl/type_traits.hpp"
+#include "timemory/tpls/cereal/cereal.hpp"
+#include "timemory/types.hpp"
+#include "timemory/version.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace bench
+{
+//--------------------------------------------------------------------------------------//
+//
+/// \struct bench::config
+/// \brief Command-line configuration
+struct config
+{
+    size_t iterations = 10000;
+    size_t repeat     = 5;
+    size_t threads    = std::min<size_t>(std::thread::hardware_concurrency(), 8);
+    int    verbose    = 0;
+
+    std::vector<size_t> depths        = { 1, 4, 16, 64 };
+    std::vector<size_t> label_lengths = { 16, 64, 256, 1024 };
+    std::string         filter        = {};
+    std::string         output        = "timemory-bench.json";
+
+    template <typename Archive>
+    void serialize(Archive& ar, const unsigned int)
+    {
+        ar(tim::cereal::make_nvp("iterations", iterations),
+           tim::cereal::make_nvp("repeat", repeat),
+           tim::cereal::make_nvp("threads", threads),
+           tim::cereal::make_nvp("depths", depths),
+           tim::cereal::make_nvp("label_lengths", label_lengths),
+           tim::cereal::make_nvp("filter", filter));
+    }
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \struct bench::result
+/// \brief Nanoseconds per operation of one benchmark. An operation is a start and a
+/// stop (plus the construction and destruction of the bundle, where applicable)
+struct result
+{
+    std::string group      = {};
+    std::string name       = {};
+    int64_t     threads    = 1;
+    int64_t     depth      = 1;
+    int64_t     operations = 0;
+    double      mean       = 0.0;
+    double      min        = 0.0;
+
+    template <typename Archive>
+    void serialize(Archive& ar, const unsigned int)
+    {
+        ar(tim::cereal::make_nvp("group", group), tim::cereal::make_nvp("name", name),
+           tim::cereal::make_nvp("threads", threads),
+           tim::cereal::make_nvp("depth", depth),
+           tim::cereal::make_nvp("operations", operations),
+           tim::cereal::make_nvp("mean_ns_per_op", mean),
+           tim::cereal::make_nvp("min_ns_per_op", min));
+    }
+
+    friend std::ostream& operator<<(std::ostream&, const result&);
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+using results_t = std::vector<result>;
+
+/// components which cannot be started without prior configuration
+template <typename Tp>
+struct is_excluded
+: std::integral_constant<bool, tim::trait::is_gotcha<Tp>::value ||
+                                   tim::trait::is_user_bundle<Tp>::value>
+{};
+//
+//--------------------------------------------------------------------------------------//
+//
+config&
+get_config();
+
+results_t&
+get_results();
+
+void
+write_results();
+}  // namespace bench
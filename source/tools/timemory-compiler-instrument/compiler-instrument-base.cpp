@@ -62,9 +62,12 @@ TIMEMORY_DEFINE_CONCRETE_TRAIT(is_available, component::monotonic_raw_clock, fal
 TIMEMORY_DEFINE_CONCRETE_TRAIT(is_available, component::user_mode_time, false_type)
 TIMEMORY_DEFINE_CONCRETE_TRAIT(is_available, component::kernel_mode_time, false_type)
 
+#include "timemory/storage/node_id_map.hpp"
 #include "timemory/timemory.hpp"
 #include "timemory/trace.hpp"
 
+#include "compiler-instrument-symbols.hpp"
+
 #include <array>
 #include <cassert>
 #include <chrono>
@@ -73,6 +76,7 @@ TIMEMORY_DEFINE_CONCRETE_TRAIT(is_available, component::kernel_mode_time, false_
 #include <dlfcn.h>
 #include <functional>
 #include <limits>
+#include <mutex>
 #include <thread>
 #include <unordered_map>
 #include <utility>
@@ -97,6 +101,10 @@ struct pthread_gotcha;
 static int64_t primary_tidx   = 0;
 static size_t  throttle_count = 1000;
 static size_t  throttle_value = 10000;
+static size_t  deferred_size  = (1 << 16);
+
+// functions excluded by size or name, read-only after initialization
+static compiler_instrument::address_filter* function_filter = nullptr;
 
 #if !defined(TIMEMORY_USE_GOTCHA)
 TIMEMORY_DEFINE_CONCRETE_TRAIT(is_available, main_gotcha, false_type)
@@ -118,6 +126,56 @@ using main_gotcha_t    = tim::component::gotcha<2, tim::component_tuple<main_got
                                              tim::type_list<main_gotcha>>;
 using main_bundle_t    = tim::auto_tuple<main_gotcha_t>;
 
+//--------------------------------------------------------------------------------------//
+//
+/// \struct deferred_trace
+/// \brief When TIMEMORY_COMPILER_DEFERRED is enabled, enter/exit only append the raw
+/// function address and a timestamp to a fixed-size per-thread buffer. When the buffer
+/// is full, the events are aggregated by address into a call-tree. The addresses are
+/// only translated into names at finalization, when the call-tree is inserted into the
+/// wall_clock storage.
+struct TIMEMORY_INTERNAL_NO_INSTRUMENT deferred_trace
+{
+    struct event
+    {
+        const void* this_fn   = nullptr;
+        const void* call_site = nullptr;
+        int64_t     timestamp = 0;
+        bool        entry     = false;
+    };
+
+    struct node
+    {
+        const void* this_fn   = nullptr;
+        size_t      parent    = 0;
+        int64_t     count     = 0;
+        int64_t     inclusive = 0;
+    };
+
+    deferred_trace(size_t _n)
+    : buffer(std::max<size_t>(_n, 2))
+    , tree(1)
+    {}
+
+    static int64_t now() { return tim::get_clock_real_now<int64_t, std::nano>(); }
+
+    void record(const void* _fn, const void* _site, bool _entry)
+    {
+        buffer[size++] = { _fn, _site, now(), _entry };
+        if(size == buffer.size())
+            aggregate();
+    }
+
+    void aggregate();
+    void finalize();
+
+    size_t                                  size     = 0;
+    std::vector<event>                      buffer   = {};
+    std::vector<node>                       tree     = {};
+    std::vector<std::pair<size_t, int64_t>> stack    = {};
+    tim::node_id_map<size_t>                children = {};
+};
+
 //--------------------------------------------------------------------------------------//
 
 template <size_t... Idx>
@@ -144,6 +202,10 @@ static unsigned long
 get_trace_size() TIMEMORY_INTERNAL_NO_INSTRUMENT;
 static auto&
 get_label_map() TIMEMORY_INTERNAL_NO_INSTRUMENT;
+static auto&
+get_deferred_trace() TIMEMORY_INTERNAL_NO_INSTRUMENT;
+static compiler_instrument::symbol_table&
+get_symbol_table() TIMEMORY_INTERNAL_NO_INSTRUMENT;
 static auto
 get_label(void*, void*) TIMEMORY_INTERNAL_NO_INSTRUMENT;
 //
@@ -236,6 +298,16 @@ get_debug()
 
 //--------------------------------------------------------------------------------------//
 
+bool
+get_deferred()
+{
+    static auto _instance =
+        new bool{ tim::get_env(TIMEMORY_SETTINGS_KEY("DEFERRED"), false) };
+    return *_instance;
+}
+
+//--------------------------------------------------------------------------------------//
+
 static auto&
 get_first()
 {
@@ -290,6 +362,31 @@ get_label_map()
 
 //--------------------------------------------------------------------------------------//
 
+static auto&
+get_deferred_trace()
+{
+    static thread_local auto _instance = new deferred_trace{ deferred_size };
+    return _instance;
+}
+
+//--------------------------------------------------------------------------------------//
+//
+//  the symbols of all the loaded objects are read once, either when the function
+//  filter is built or the first time a thread finalizes its deferred trace
+//
+static compiler_instrument::symbol_table&
+get_symbol_table()
+{
+    static auto _instance = []() {
+        auto* _table = new compiler_instrument::symbol_table{};
+        _table->load();
+        return _table;
+    }();
+    return *_instance;
+}
+
+//--------------------------------------------------------------------------------------//
+
 static auto
 get_label(void* this_fn, void* call_site)
 {
@@ -333,6 +430,134 @@ get_label(void* this_fn, void* call_site)
 
 //--------------------------------------------------------------------------------------//
 
+void
+deferred_trace::aggregate()
+{
+    for(size_t i = 0; i < size; ++i)
+    {
+        const auto& _event = buffer[i];
+        if(_event.entry)
+        {
+            size_t _parent = (stack.empty()) ? 0 : stack.back().first;
+            auto   _key    = reinterpret_cast<intptr_t>(_event.this_fn);
+            auto*  _child  = children.find(_parent, _key);
+            if(!_child)
+            {
+                tree.emplace_back(node{ _event.this_fn, _parent, 0, 0 });
+                _child = &children.insert(_parent, _key, tree.size() - 1);
+            }
+            stack.emplace_back(*_child, _event.timestamp);
+        }
+        else
+        {
+            // exits without a matching entry (e.g. the entry happened before the
+            // thread was enabled) are ignored and frames skipped by a non-local
+            // exit are closed at the same time as their caller
+            auto ritr = std::find_if(stack.rbegin(), stack.rend(),
+                                     [&](const std::pair<size_t, int64_t>& _v) {
+                                         return tree[_v.first].this_fn == _event.this_fn;
+                                     });
+            if(ritr == stack.rend())
+                continue;
+            auto _n = std::distance(stack.rbegin(), ritr) + 1;
+            for(decltype(_n) j = 0; j < _n; ++j)
+            {
+                auto& _node = tree[stack.back().first];
+                _node.count += 1;
+                _node.inclusive += _event.timestamp - stack.back().second;
+                stack.pop_back();
+            }
+        }
+    }
+    size = 0;
+}
+
+//--------------------------------------------------------------------------------------//
+
+void
+deferred_trace::finalize()
+{
+    aggregate();
+
+    // close the functions which are still running
+    auto _now = now();
+    while(!stack.empty())
+    {
+        auto& _node = tree[stack.back().first];
+        _node.count += 1;
+        _node.inclusive += _now - stack.back().second;
+        stack.pop_back();
+    }
+
+    if(tree.size() < 2)
+        return;
+
+    // translate each unique address into a label
+    std::unordered_map<const void*, size_t> _labels{};
+    {
+        static std::mutex           _mutex{};
+        std::lock_guard<std::mutex> _lk{ _mutex };
+        auto&                       _symbols = get_symbol_table();
+        for(size_t i = 1; i < tree.size(); ++i)
+        {
+            auto _fn = tree[i].this_fn;
+            if(_labels.find(_fn) != _labels.end())
+                continue;
+            std::string _label{};
+            Dl_info     _finfo;
+            const auto* _sym = _symbols.find(_fn);
+            if(_sym)
+                _label = TIMEMORY_JOIN("", '[', _sym->name, ']', '[',
+                                       _symbols.file(*_sym), ']');
+            else if(dladdr(_fn, &_finfo) != 0 && _finfo.dli_sname)
+                _label = TIMEMORY_JOIN("", '[', _finfo.dli_sname, ']', '[',
+                                       _finfo.dli_fname, ']');
+            else
+                _label = TIMEMORY_JOIN("", '[', _fn, ']');
+            _labels.emplace(_fn, tim::add_hash_id(_label));
+        }
+    }
+
+    // the nodes are created after their parent so the children lists are in order
+    std::vector<std::vector<size_t>> _children(tree.size());
+    for(size_t i = 1; i < tree.size(); ++i)
+        _children[tree[i].parent].emplace_back(i);
+
+    // insert the call-tree depth-first into the storage
+    auto* _storage = tim::storage<wall_clock>::instance();
+    if(!_storage)
+        return;
+
+    std::vector<std::pair<size_t, size_t>> _dfs{ { 0, 0 } };
+    while(!_dfs.empty())
+    {
+        auto& _top = _dfs.back();
+        if(_top.second == _children[_top.first].size())
+        {
+            if(_top.first != 0)
+                _storage->pop();
+            _dfs.pop_back();
+            continue;
+        }
+
+        auto  _idx  = _children[_top.first][_top.second++];
+        auto& _node = tree[_idx];
+        auto  itr   = _storage->insert(tim::scope::get_default(), wall_clock{},
+                                    _labels.at(_node.this_fn));
+        wall_clock _obj{};
+        _obj.set_value(_node.inclusive);
+        _obj.set_accum(_node.inclusive);
+        _obj.set_laps(_node.count);
+        tim::operation::plus<wall_clock>(itr->obj(), _obj);
+        _dfs.emplace_back(_idx, 0);
+    }
+
+    tree.resize(1);
+    children.clear();
+}
+
+//--------------------------------------------------------------------------------------//
+
 static void
 initialize(const char* _exe_name)
 {
@@ -391,6 +616,44 @@ initialize(const char* _exe_name)
     throttle_value =
         tim::get_env(TIMEMORY_SETTINGS_KEY("THROTTLE_VALUE"), throttle_value);
 
+    // deferred symbolization
+    deferred_size =
+        tim::get_env(TIMEMORY_SETTINGS_KEY("DEFERRED_BUFFER_SIZE"), deferred_size);
+
+    // static filtering of the functions by size and name
+    auto _min_size = tim::get_env<size_t>(TIMEMORY_SETTINGS_KEY("MIN_FUNCTION_SIZE"), 0);
+    auto _func_exclude =
+        tim::get_env<std::string>(TIMEMORY_SETTINGS_KEY("FUNCTION_EXCLUDE"), "");
+    auto _module_exclude =
+        tim::get_env<std::string>(TIMEMORY_SETTINGS_KEY("MODULE_EXCLUDE"), "");
+    if(_min_size > 0 || !_func_exclude.empty() || !_module_exclude.empty())
+    {
+        constexpr auto _rc = std::regex_constants::optimize | std::regex_constants::egrep;
+        using regex_vec_t  = compiler_instrument::address_filter::regex_vec_t;
+        auto _get_regexes  = [_rc](const std::string& _env) {
+            regex_vec_t _regexes{};
+            for(const auto& itr : tim::delimit(_env, ";"))
+                _regexes.emplace_back(itr, _rc);
+            return _regexes;
+        };
+
+        auto  _filter = new compiler_instrument::address_filter{};
+        auto& _table  = get_symbol_table();
+        // main is required for finalization
+        auto _n = _filter->build(
+            _table, _min_size, _get_regexes(_func_exclude),
+            _get_regexes(_module_exclude), std::regex{ "^[_]*main$", _rc },
+            [](const std::string& _name) { return tim::demangle(_name); });
+        printf("[%i]> timemory-compiler-instrument will not instrument %lu of %lu "
+               "functions\n",
+               (int) tim::process::get_id(), (unsigned long) _n,
+               (unsigned long) _table.symbols().size());
+        if(_filter->empty())
+            delete _filter;
+        else
+            function_filter = _filter;
+    }
+
     // output path
     if(tim::get_env<std::string>(TIMEMORY_SETTINGS_KEY("OUTPUT_PATH"), "").empty())
     {
@@ -472,6 +735,12 @@ finalize()
             std::get<2>(itr)->stop();
     }
 
+    // symbolize and insert the deferred call-tree
+    if(get_deferred() && get_deferred_trace())
+        get_deferred_trace()->finalize();
+    delete get_deferred_trace();
+    get_deferred_trace() = nullptr;
+
     // clean up trace map
     if(get_trace_vec())
         get_trace_vec()->clear();
@@ -529,10 +798,25 @@ extern "C"
 {
     void timemory_profile_func_enter(void* this_fn, void* call_site)
     {
+        if(function_filter && (*function_filter)(this_fn))
+            return;
+
         tim::trace::lock<tim::trace::compiler> lk{};
         if(!lk || !get_enabled() || !get_thread_enabled())
             return;
 
+        if(get_deferred())
+        {
+            // the main function is only searched for until it is found
+            if(!get_main_wrapped() && get_first().first == nullptr &&
+               tim::threading::get_id() == primary_tidx)
+                get_label(this_fn, call_site);
+            const auto& _deferred = get_deferred_trace();
+            if(_deferred)
+                _deferred->record(this_fn, call_site, true);
+            return;
+        }
+
         const auto& _trace_vec = get_trace_vec();
         if(!_trace_vec)
             return;
@@ -569,11 +853,14 @@ extern "C"
     //
     void timemory_profile_func_exit(void* this_fn, void* call_site)
     {
+        if(function_filter && (*function_filter)(this_fn))
+            return;
+
         tim::trace::lock<tim::trace::compiler> lk{};
         if(!lk || !get_enabled() || !get_thread_enabled())
             return;
 
-        if(get_debug())
+        if(get_debug() && !get_deferred())
         {
             fprintf(stderr, "[%i][%i][timemory-compiler-inst]> %s\n",
                     (int) tim::process::get_id(), (int) tim::threading::get_id(),
@@ -592,6 +879,16 @@ extern "C"
                 get_enabled() = false;
         }
 
+        if(get_deferred())
+        {
+            const auto& _deferred = get_deferred_trace();
+            if(_deferred)
+                _deferred->record(this_fn, call_site, false);
+            if(_is_first)
+                finalize();
+            return;
+        }
+
         const auto& _trace_vec = get_trace_vec();
         if(!_trace_vec)
             return;
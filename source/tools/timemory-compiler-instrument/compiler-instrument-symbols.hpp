@@ -0,0 +1,322 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * \file compiler-instrument-symbols.hpp
+ * \brief Reads the function symbols of the executable and the loaded libraries from
+ * their ELF symbol tables and builds the filter of the functions which are not
+ * instrumented
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <elf.h>
+#include <fcntl.h>
+#include <link.h>
+#include <regex>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace compiler_instrument
+{
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \struct compiler_instrument::function_symbol
+/// \brief The runtime address range of a function and the index of the file which
+/// defines it
+struct function_symbol
+{
+    uintptr_t   address = 0;
+    uintptr_t   size    = 0;
+    size_t      file    = 0;
+    std::string name    = {};
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \class compiler_instrument::symbol_table
+/// \brief Collects the function symbols of every object loaded in the process. The
+/// static symbol table (.symtab) is used when the object has not been stripped since
+/// it contains the non-exported functions which dladdr cannot resolve, otherwise the
+/// dynamic symbol table (.dynsym) is used.
+class symbol_table
+{
+public:
+    using symbol_vec_t = std::vector<function_symbol>;
+    using string_vec_t = std::vector<std::string>;
+
+    /// read the symbols of all the loaded objects. Calling it again re-reads them
+    void load()
+    {
+        m_files.clear();
+        m_symbols.clear();
+        dl_iterate_phdr(&symbol_table::read_object, this);
+        std::sort(m_symbols.begin(), m_symbols.end(),
+                  [](const function_symbol& lhs, const function_symbol& rhs) {
+                      return (lhs.address == rhs.address) ? (lhs.size > rhs.size)
+                                                          : (lhs.address < rhs.address);
+                  });
+        // aliases of the same function, keep the first (largest) entry
+        m_symbols.erase(std::unique(m_symbols.begin(), m_symbols.end(),
+                                    [](const function_symbol& lhs,
+                                       const function_symbol& rhs) {
+                                        return lhs.address == rhs.address;
+                                    }),
+                        m_symbols.end());
+    }
+
+    /// returns nullptr if the address is not within a known function
+    const function_symbol* find(const void* _addr) const
+    {
+        auto _val = reinterpret_cast<uintptr_t>(_addr);
+        auto itr  = std::upper_bound(
+            m_symbols.begin(), m_symbols.end(), _val,
+            [](uintptr_t _v, const function_symbol& _sym) { return _v < _sym.address; });
+        if(itr == m_symbols.begin())
+            return nullptr;
+        --itr;
+        // symbols without a size only match their exact address
+        auto _end = itr->address + std::max<uintptr_t>(itr->size, 1);
+        return (_val < _end) ? &(*itr) : nullptr;
+    }
+
+    const std::string& file(const function_symbol& _sym) const
+    {
+        return m_files.at(_sym.file);
+    }
+
+    const symbol_vec_t& symbols() const { return m_symbols; }
+    const string_vec_t& files() const { return m_files; }
+    bool                empty() const { return m_symbols.empty(); }
+
+private:
+    static constexpr unsigned char elf_class =
+        (__ELF_NATIVE_CLASS == 64) ? ELFCLASS64 : ELFCLASS32;
+
+    static int read_object(dl_phdr_info* _info, size_t, void* _data)
+    {
+        auto* _table = static_cast<symbol_table*>(_data);
+        // the executable has an empty name
+        if(_info->dlpi_name && strlen(_info->dlpi_name) > 0)
+        {
+            _table->read_file(_info->dlpi_name, _info->dlpi_name, _info->dlpi_addr);
+        }
+        else
+        {
+            char    _exe[PATH_MAX];
+            ssize_t _n = readlink("/proc/self/exe", _exe, sizeof(_exe) - 1);
+            _exe[(_n > 0) ? _n : 0] = '\0';
+            _table->read_file("/proc/self/exe", (_n > 0) ? _exe : "/proc/self/exe",
+                              _info->dlpi_addr);
+        }
+        return 0;
+    }
+
+    void read_file(const char* _fpath, const std::string& _path, uintptr_t _base)
+    {
+        int _fd = ::open(_fpath, O_RDONLY);
+        if(_fd < 0)
+            return;
+
+        struct stat _stat;
+        if(fstat(_fd, &_stat) != 0 || _stat.st_size < (off_t) sizeof(ElfW(Ehdr)))
+        {
+            ::close(_fd);
+            return;
+        }
+
+        auto  _len  = static_cast<size_t>(_stat.st_size);
+        void* _addr = mmap(nullptr, _len, PROT_READ, MAP_PRIVATE, _fd, 0);
+        ::close(_fd);
+        if(_addr == MAP_FAILED)
+            return;
+
+        read_image(static_cast<const char*>(_addr), _len, _path, _base);
+        munmap(_addr, _len);
+    }
+
+    void read_image(const char* _data, size_t _len, const std::string& _path,
+                    uintptr_t _base)
+    {
+        const auto* _ehdr = reinterpret_cast<const ElfW(Ehdr)*>(_data);
+        if(memcmp(_ehdr->e_ident, ELFMAG, SELFMAG) != 0 ||
+           _ehdr->e_ident[EI_CLASS] != elf_class ||
+           _ehdr->e_shentsize != sizeof(ElfW(Shdr)) ||
+           _ehdr->e_shoff + _ehdr->e_shnum * sizeof(ElfW(Shdr)) > _len)
+            return;
+
+        const auto* _shdr = reinterpret_cast<const ElfW(Shdr)*>(_data + _ehdr->e_shoff);
+        const ElfW(Shdr)* _symtab = nullptr;
+        for(size_t i = 0; i < _ehdr->e_shnum; ++i)
+        {
+            if(_shdr[i].sh_type == SHT_SYMTAB)
+                _symtab = &_shdr[i];
+            else if(_shdr[i].sh_type == SHT_DYNSYM && !_symtab)
+                _symtab = &_shdr[i];
+        }
+
+        if(!_symtab || _symtab->sh_link >= _ehdr->e_shnum ||
+           _symtab->sh_offset + _symtab->sh_size > _len)
+            return;
+
+        const auto& _strtab = _shdr[_symtab->sh_link];
+        if(_strtab.sh_offset + _strtab.sh_size > _len)
+            return;
+
+        const auto* _syms = reinterpret_cast<const ElfW(Sym)*>(_data + _symtab->sh_offset);
+        const char* _strs = _data + _strtab.sh_offset;
+        size_t      _nsym = _symtab->sh_size / sizeof(ElfW(Sym));
+        size_t      _file = m_files.size();
+        m_files.emplace_back(_path);
+
+        for(size_t i = 0; i < _nsym; ++i)
+        {
+            const auto& _sym = _syms[i];
+            if(ELF64_ST_TYPE(_sym.st_info) != STT_FUNC || _sym.st_shndx == SHN_UNDEF ||
+               _sym.st_value == 0 || _sym.st_name >= _strtab.sh_size)
+                continue;
+            m_symbols.emplace_back(function_symbol{ _base + _sym.st_value, _sym.st_size,
+                                                    _file,
+                                                    std::string{ _strs + _sym.st_name } });
+        }
+    }
+
+private:
+    string_vec_t m_files   = {};
+    symbol_vec_t m_symbols = {};
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \class compiler_instrument::address_filter
+/// \brief Bitmap of the entry addresses of the functions which are excluded from the
+/// instrumentation. There is one bitmap per object spanning the first to the last
+/// excluded function so that checking an address is a range check and a bit test.
+class address_filter
+{
+public:
+    using regex_vec_t = std::vector<std::regex>;
+    using name_func_t = std::string (*)(const std::string&);
+
+    /// excludes the functions smaller than \param _min_size bytes, the functions whose
+    /// name (transformed by \param _name_func, e.g. demangled) matches one of
+    /// \param _funcs and all the functions of the files matching one of
+    /// \param _modules. Functions matching \param _keep are never excluded.
+    /// Returns the number of excluded functions
+    size_t build(const symbol_table& _table, uintptr_t _min_size,
+                 const regex_vec_t& _funcs, const regex_vec_t& _modules,
+                 const std::regex& _keep, name_func_t _name_func)
+    {
+        m_ranges.clear();
+
+        const auto& _files = _table.files();
+        std::vector<bool> _file_excluded(_files.size(), false);
+        for(size_t i = 0; i < _files.size(); ++i)
+            _file_excluded[i] = matches(_modules, _files[i]);
+
+        // symbols are sorted by address so those from the same object are contiguous
+        std::vector<std::pair<size_t, uintptr_t>> _excluded{};
+        for(const auto& itr : _table.symbols())
+        {
+            // functions without a size (e.g. hand-written assembly) are kept unless
+            // explicitly excluded
+            bool _small = (itr.size > 0 && itr.size < _min_size);
+            if(!_small && !_file_excluded.at(itr.file) && _funcs.empty())
+                continue;
+            auto _name = (_name_func) ? _name_func(itr.name) : itr.name;
+            if(std::regex_search(_name, _keep))
+                continue;
+            if(_small || _file_excluded.at(itr.file) || matches(_funcs, _name))
+                _excluded.emplace_back(itr.file, itr.address);
+        }
+
+        for(size_t i = 0; i < _excluded.size();)
+        {
+            size_t j = i;
+            while(j < _excluded.size() && _excluded.at(j).first == _excluded.at(i).first)
+                ++j;
+            range _range{};
+            _range.begin = _excluded.at(i).second;
+            _range.end   = _excluded.at(j - 1).second + 1;
+            _range.bits.resize((_range.end - _range.begin + 63) / 64, 0);
+            for(; i < j; ++i)
+            {
+                auto _off = _excluded.at(i).second - _range.begin;
+                _range.bits.at(_off / 64) |= (static_cast<uint64_t>(1) << (_off % 64));
+            }
+            m_ranges.emplace_back(std::move(_range));
+        }
+
+        return _excluded.size();
+    }
+
+    bool empty() const { return m_ranges.empty(); }
+
+    bool operator()(const void* _addr) const
+    {
+        auto _val = reinterpret_cast<uintptr_t>(_addr);
+        for(const auto& itr : m_ranges)
+        {
+            if(_val >= itr.begin && _val < itr.end)
+            {
+                auto _off = _val - itr.begin;
+                return (itr.bits[_off / 64] >> (_off % 64)) & 1;
+            }
+        }
+        return false;
+    }
+
+private:
+    static bool matches(const regex_vec_t& _regexes, const std::string& _str)
+    {
+        for(const auto& itr : _regexes)
+        {
+            if(std::regex_search(_str, itr))
+                return true;
+        }
+        return false;
+    }
+
+    struct range
+    {
+        uintptr_t             begin = 0;
+        uintptr_t             end   = 0;
+        std::vector<uint64_t> bits  = {};
+    };
+
+private:
+    std::vector<range> m_ranges = {};
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+}  // namespace compiler_instrument
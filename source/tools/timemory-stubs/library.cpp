@@ -94,6 +94,9 @@ extern "C"
     void     timemory_end_record(uint64_t) {}
     void     timemory_push_region(const char*) {}
     void     timemory_pop_region(const char*) {}
+    uint64_t timemory_register_region(const char*) { RETURN_MAX(uint64_t); }
+    void     timemory_push_region_handle(uint64_t) {}
+    void     timemory_pop_region_handle(uint64_t) {}
 
     bool timemory_is_throttled(const char*) { return true; }
     void timemory_add_hash_id(uint64_t, const char*) {}
@@ -126,5 +129,8 @@ extern "C"
     void timemory_end_record_(uint64_t) {}
     void timemory_push_region_(const char*) {}
     void timemory_pop_region_(const char*) {}
+    uint64_t timemory_register_region_(const char*) { RETURN_MAX(uint64_t); }
+    void     timemory_push_region_handle_(uint64_t) {}
+    void     timemory_pop_region_handle_(uint64_t) {}
 
 }  // extern "C"
@@ -26,6 +26,7 @@
 #include "timemory/compat/library.h"
 #include "timemory/library.h"
 #include "timemory/runtime/configure.hpp"
+#include "timemory/storage/node_id_map.hpp"
 #include "timemory/timemory.hpp"
 #include "timemory/utility/bits/signals.hpp"
 
@@ -33,19 +34,57 @@
 #    include "timemory/backends/types/mpi/extern.hpp"
 #endif
 
+#include <atomic>
 #include <cstdarg>
 #include <cstdlib>
 #include <deque>
 #include <iostream>
+#include <limits>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 
 using namespace tim::component;
 
-using string_t       = std::string;
-using overhead_map_t = std::unordered_map<size_t, std::pair<wall_clock, size_t>>;
-using throttle_set_t = std::set<size_t>;
-using traceset_t     = tim::component_bundle<TIMEMORY_API, user_trace_bundle>;
-using trace_map_t    = std::unordered_map<size_t, std::deque<traceset_t>>;
+using string_t   = std::string;
+using traceset_t = tim::component_bundle<TIMEMORY_API, user_trace_bundle>;
+
+//======================================================================================//
+//
+/// the throttling state of a traced function which is shared by all threads. The
+/// average call time is an exponentially decayed estimate which is updated by whichever
+/// thread completes a window of throttle_count calls so the decision applies to every
+/// thread and cost changes between phases of the application are picked up
+struct trace_throttle
+{
+    std::atomic<bool>   throttled{ false };
+    std::atomic<size_t> suppressed{ 0 };
+    std::atomic<double> cost{ -1.0 };
+};
+
+//======================================================================================//
+//
+/// the per-thread state of a traced function. The 64-bit hashes are mapped to a dense
+/// index once so push/pop only probe the per-thread cache and then index into the
+/// per-thread table instead of looking up the hash in several maps
+struct trace_entry
+{
+    uint64_t               hash     = 0;
+    size_t                 count    = 0;
+    trace_throttle*        throttle = nullptr;
+    wall_clock             overhead = {};
+    std::vector<bool>      measured = {};
+    std::deque<traceset_t> stack    = {};
+};
+
+// maps the hash to the index in the per-thread table and is shared by all threads
+using trace_index_map_t = std::unordered_map<uint64_t, size_t>;
+// a deque so that the throttle state does not move when new hashes are registered
+using trace_throttle_table_t = std::deque<trace_throttle>;
+// maps the (possibly aliased) id passed to push/pop to the index in the per-thread table
+using trace_cache_t = tim::node_id_map<size_t>;
+// a deque so that growing the table does not move the bundles which are running
+using trace_table_t = std::deque<trace_entry>;
 
 //======================================================================================//
 
@@ -53,38 +92,107 @@ static std::atomic<uint32_t> library_trace_count{ 0 };
 
 //--------------------------------------------------------------------------------------//
 
-static auto&
-get_overhead() TIMEMORY_VISIBILITY("default");
-static auto&
-get_throttle() TIMEMORY_VISIBILITY("default");
-static trace_map_t&
-get_trace_map() TIMEMORY_VISIBILITY("default");
+static trace_cache_t&
+get_trace_cache() TIMEMORY_VISIBILITY("default");
+static trace_table_t&
+get_trace_table() TIMEMORY_VISIBILITY("default");
+
+//--------------------------------------------------------------------------------------//
+//
+//  returns the index of the hash and the shared throttle state. If the hash is not
+//  registered and _insert is false, returns the max index and nullptr
+//
+static std::pair<size_t, trace_throttle*>
+get_trace_index(uint64_t _hash, bool _insert)
+{
+    static std::mutex             _mutex{};
+    static trace_index_map_t      _instance{};
+    static trace_throttle_table_t _throttle{};
+
+    std::lock_guard<std::mutex> _lk{ _mutex };
+    auto                        itr = _instance.find(_hash);
+    if(itr != _instance.end())
+        return { itr->second, &_throttle[itr->second] };
+    if(!_insert)
+        return { std::numeric_limits<size_t>::max(), nullptr };
+    _throttle.emplace_back();
+    auto _idx = _instance.emplace(_hash, _instance.size()).first->second;
+    return { _idx, &_throttle[_idx] };
+}
+
+//--------------------------------------------------------------------------------------//
+//
+//  merges the average call time of the latest window into the decayed estimate
+//
+static double
+update_trace_cost(trace_throttle& _throttle, double _value)
+{
+    double _decay = tim::settings::throttle_decay();
+    if(!(_decay > 0.0 && _decay < 1.0))
+        _decay = 1.0;
+
+    double _cost = _throttle.cost.load(std::memory_order_relaxed);
+    double _next = _value;
+    do
+    {
+        _next = (_cost < 0.0) ? _value : (_decay * _value + (1.0 - _decay) * _cost);
+    } while(!_throttle.cost.compare_exchange_weak(_cost, _next));
+    return _next;
+}
 
 //--------------------------------------------------------------------------------------//
 
-static auto&
-get_overhead()
+static trace_cache_t&
+get_trace_cache()
 {
-    static thread_local auto _instance = std::make_unique<overhead_map_t>();
+    static thread_local trace_cache_t _instance{};
     return _instance;
 }
 
 //--------------------------------------------------------------------------------------//
 
-static auto&
-get_throttle()
+static trace_table_t&
+get_trace_table()
 {
-    static thread_local auto _instance = std::make_unique<throttle_set_t>();
+    static thread_local trace_table_t _instance{};
     return _instance;
 }
 
 //--------------------------------------------------------------------------------------//
+//
+//  returns nullptr if the id has not been registered. Only the first push/pop of an id
+//  on each thread resolves the aliases and acquires the lock on the shared index
+//
+static trace_entry*
+get_trace_entry(uint64_t _id)
+{
+    auto& _table = get_trace_table();
+    auto* _idx   = get_trace_cache().find(0, _id);
+    if(_idx)
+        return &_table[*_idx];
+
+    // ids computed outside of timemory (e.g. timemory-run) are registered as aliases
+    auto _hash = tim::get_hash_id(tim::get_hash_aliases(), _id);
+    if(tim::get_hash_ids()->find(_hash) == tim::get_hash_ids()->end())
+        return nullptr;
+
+    auto _entry = get_trace_index(_hash, true);
+    if(_table.size() <= _entry.first)
+        _table.resize(_entry.first + 1);
+    _table[_entry.first].hash     = _hash;
+    _table[_entry.first].throttle = _entry.second;
+    get_trace_cache().insert(0, _id, _entry.first);
+    return &_table[_entry.first];
+}
 
-static trace_map_t&
-get_trace_map()
+//--------------------------------------------------------------------------------------//
+//
+//  lookup by the hash of the name without registering it
+//
+static trace_throttle*
+find_trace_throttle(const char* name)
 {
-    static thread_local trace_map_t _instance;
-    return _instance;
+    return get_trace_index(tim::get_hash_id(name), false).second;
 }
 
 //--------------------------------------------------------------------------------------//
@@ -332,7 +440,6 @@ setup_mpi_gotcha()
 
 static bool                                mpi_gotcha_configured = setup_mpi_gotcha();
 static std::shared_ptr<mpi_trace_bundle_t> mpi_gotcha_handle{ nullptr };
-static std::map<size_t, string_t>          master_hash_ids;
 
 //--------------------------------------------------------------------------------------//
 //
@@ -355,18 +462,21 @@ extern "C"
     //
     bool timemory_is_throttled(const char* name)
     {
-        size_t _id = tim::get_hash_id(name);
-        return (get_throttle()->count(_id) > 0);
+        auto* _throttle = find_trace_throttle(name);
+        return (_throttle && _throttle->throttled.load());
     }
     //
     //----------------------------------------------------------------------------------//
     //
     void timemory_reset_throttle(const char* name)
     {
-        size_t _id = tim::get_hash_id(name);
-        auto   itr = get_throttle()->find(_id);
-        if(itr != get_throttle()->end())
-            get_throttle()->erase(itr);
+        auto* _throttle = find_trace_throttle(name);
+        if(_throttle)
+        {
+            _throttle->throttled.store(false);
+            _throttle->suppressed.store(0);
+            _throttle->cost.store(-1.0);
+        }
     }
     //
     //----------------------------------------------------------------------------------//
@@ -387,14 +497,6 @@ extern "C"
         auto _id = tim::add_hash_id(name);
         if(_id != id)
             tim::add_hash_id(_id, id);
-
-        // master thread adds the ids
-        if(tim::threading::get_id() == 0)
-        {
-            master_hash_ids[id] = name;
-            if(_id != id)
-                master_hash_ids[_id] = name;
-        }
     }
     //
     //----------------------------------------------------------------------------------//
@@ -412,17 +514,7 @@ extern "C"
     //
     void timemory_copy_hash_ids()
     {
-        tim::trace::lock<tim::trace::library> lk{};
-        static thread_local bool              once_per_thread = false;
-        if(!once_per_thread && tim::threading::get_id() > 0)
-        {
-            if(tim::settings::debug())
-                fprintf(stderr, "[timemory-trace]> copying hash ids...\n");
-            once_per_thread  = true;
-            auto _master_ids = master_hash_ids;
-            for(const auto& itr : _master_ids)
-                timemory_add_hash_id(itr.first, itr.second.c_str());
-        }
+        // the hash ids are shared by all threads so there is nothing to copy
     }
     //
     //----------------------------------------------------------------------------------//
@@ -432,9 +524,6 @@ extern "C"
         if(!timemory_trace_is_initialized())
             timemory_trace_init("", true, "");
 
-        static thread_local auto _copied = (timemory_copy_hash_ids(), true);
-        tim::consume_parameters(_copied);
-
         tim::trace::lock<tim::trace::library> lk{};
 
         if(!lk)
@@ -458,37 +547,53 @@ extern "C"
             return;
         }
 
-        if(get_throttle()->count(id) > 0)
+        auto* _entry = get_trace_entry(id);
+        if(!_entry)
+            return;
+
+        auto& _throttle = *_entry->throttle;
+        if(_throttle.throttled.load(std::memory_order_relaxed))
         {
+            // once throttle_resample calls have been skipped, measure the function
+            // again so that the throttling is re-evaluated after throttle_count calls
+            auto _resample = tim::settings::throttle_resample();
+            if(_resample == 0 || _throttle.suppressed.fetch_add(1) + 1 < _resample)
+            {
 #if defined(DEBUG) || !defined(NDEBUG)
-            if(tim::settings::debug())
-                PRINT_HERE("trace %llu is throttled", (unsigned long long) id);
+                if(tim::settings::debug())
+                    PRINT_HERE("trace %llu is throttled",
+                               (unsigned long long) _entry->hash);
 #endif
-            return;
+                // discard the partial window from before the throttling
+                if(_entry->count > 0)
+                {
+                    _entry->overhead.reset();
+                    _entry->count = 0;
+                }
+                _entry->measured.push_back(false);
+                return;
+            }
+            _throttle.suppressed.store(0);
+            _throttle.throttled.store(false);
         }
 
-        auto& _trace_map = get_trace_map();
-        auto& _overh_map = *get_overhead();
-
-        if(tim::get_hash_ids()->find(id) == tim::get_hash_ids()->end())
-            return;
-
         if(tim::settings::debug())
         {
-            int64_t  n    = _trace_map[id].size();
-            auto     itr  = tim::get_hash_ids()->find(id);
+            int64_t  n    = _entry->stack.size();
+            auto     itr  = tim::get_hash_ids()->find(_entry->hash);
             string_t name = (itr != tim::get_hash_ids()->end()) ? itr->second : "unknown";
             fprintf(stderr,
                     "beginning trace for '%s' (id = %llu, offset = %lli, rank = %i, pid "
                     "= %i, thread = %i)...\n",
-                    name.c_str(), (long long unsigned) id, (long long int) n,
+                    name.c_str(), (long long unsigned) _entry->hash, (long long int) n,
                     tim::dmp::rank(), (int) tim::process::get_id(),
                     (int) tim::threading::get_id());
         }
 
-        _trace_map[id].emplace_back(traceset_t{ id });
-        _trace_map[id].back().start();
-        _overh_map[id].first.start();
+        _entry->measured.push_back(true);
+        _entry->stack.emplace_back(traceset_t{ _entry->hash });
+        _entry->stack.back().start();
+        _entry->overhead.start();
     }
     //
     //----------------------------------------------------------------------------------//
@@ -499,10 +604,9 @@ extern "C"
         if(!get_library_state()[0] || get_library_state()[1])
             return;
 
-        auto& _trace_map = get_trace_map();
-        if(!tim::settings::enabled() && _trace_map.empty())
+        if(!tim::settings::enabled() && get_trace_table().empty())
         {
-            if(tim::settings::debug() && _trace_map.empty())
+            if(tim::settings::debug())
                 fprintf(stderr,
                         "[timemory-trace]> timemory_pop_trace_hash(%lu) failed. "
                         "trace_map empty...\n",
@@ -510,64 +614,73 @@ extern "C"
             return;
         }
 
-        int64_t ntotal = _trace_map[id].size();
-        int64_t offset = ntotal - 1;
+        // if the id was never registered, there was no push
+        auto* _entry = get_trace_entry(id);
+        if(!_entry)
+            return;
+
+        // if there were no entries, return (pop called without a push)
+        if(_entry->measured.empty())
+            return;
+
+        // the push was skipped because the function was throttled
+        bool _measured = _entry->measured.back();
+        _entry->measured.pop_back();
+        if(!_measured)
+            return;
 
         if(tim::settings::debug())
         {
-            auto     itr  = tim::get_hash_ids()->find(id);
+            int64_t  offset = _entry->stack.size() - 1;
+            auto     itr    = tim::get_hash_ids()->find(_entry->hash);
             string_t name = (itr != tim::get_hash_ids()->end()) ? itr->second : "unknown";
             fprintf(stderr,
                     "ending trace for '%s' (id = %llu, offset = %lli, rank = %i, pid = "
                     "%i, thread = %i)...\n",
-                    name.c_str(), (long long unsigned) id, (long long int) offset,
-                    tim::dmp::rank(), (int) tim::process::get_id(),
-                    (int) tim::threading::get_id());
+                    name.c_str(), (long long unsigned) _entry->hash,
+                    (long long int) offset, tim::dmp::rank(),
+                    (int) tim::process::get_id(), (int) tim::threading::get_id());
         }
 
-        (*get_overhead())[id].first.stop();
-
-        // if there were no entries, return (pop called without a push)
-        if(offset < 0)
-            return;
-
-        if(offset >= 0 && ntotal > 0)
-        {
-            _trace_map[id].back().stop();
-            _trace_map[id].pop_back();
-        }
+        _entry->overhead.stop();
+        _entry->stack.back().stop();
+        _entry->stack.pop_back();
 
-        if(get_throttle() && get_throttle()->count(id) > 0)
+        // another thread throttled the function while it was running
+        auto& _throttle = *_entry->throttle;
+        if(_throttle.throttled.load(std::memory_order_relaxed))
             return;
 
-        auto _count = ++(get_overhead()->at(id).second);
+        auto _count = ++(_entry->count);
 
         if(_count % tim::settings::throttle_count() == 0)
         {
-            auto _accum = get_overhead()->at(id).first.get_accum() / _count;
+            auto _accum = static_cast<size_t>(update_trace_cost(
+                _throttle, _entry->overhead.get_accum() / static_cast<double>(_count)));
             if(_accum < tim::settings::throttle_value())
             {
                 if(tim::settings::debug() || tim::settings::verbose() > 0)
                 {
-                    auto name = tim::get_hash_ids()->find(id)->second;
+                    auto name = tim::get_hash_ids()->find(_entry->hash)->second;
                     fprintf(
                         stderr,
-                        "[timemory-trace]> Throttling all future calls to '%s' on rank = "
-                        "%i, pid = "
-                        "%i, thread = %i. avg runtime = %lu ns from %lu invocations... "
+                        "[timemory-trace]> Throttling calls to '%s' on all threads of "
+                        "rank = %i, pid = %i (decided on thread = %i). decayed avg "
+                        "runtime = %lu ns after %lu invocations... "
                         "Consider eliminating from instrumentation...\n",
                         name.c_str(), tim::dmp::rank(), (int) tim::process::get_id(),
                         (int) tim::threading::get_id(), (unsigned long) _accum,
                         (unsigned long) _count);
                 }
-                get_throttle()->insert(id);
+                _throttle.suppressed.store(0);
+                _throttle.throttled.store(true);
             }
             else
             {
                 if(_accum < (10 * tim::settings::throttle_value()) &&
                    (tim::settings::debug() || tim::settings::verbose() > 1))
                 {
-                    auto name = tim::get_hash_ids()->find(id)->second;
+                    auto name = tim::get_hash_ids()->find(_entry->hash)->second;
                     fprintf(
                         stderr,
                         "[timemory-trace]> Warning! function call '%s' within an order "
@@ -580,8 +693,8 @@ extern "C"
                         (unsigned long) _count);
                 }
             }
-            get_overhead()->at(id).first.reset();
-            get_overhead()->at(id).second = 0;
+            _entry->overhead.reset();
+            _entry->count = 0;
         }
     }
     //
@@ -827,17 +940,18 @@ extern "C"
         // clean up any remaining entries
         if(!_skip_stop)
         {
-            for(auto& itr : get_trace_map())
+            for(auto& itr : get_trace_table())
             {
-                for(auto& eitr : itr.second)
+                for(auto& eitr : itr.stack)
                     eitr.stop();
                 // delete all the records
-                itr.second.clear();
+                itr.stack.clear();
             }
         }
 
         // delete all the records
-        get_trace_map().clear();
+        get_trace_cache().clear();
+        get_trace_table().clear();
 
         // deactivate the gotcha wrappers
         if(use_mpi_gotcha)